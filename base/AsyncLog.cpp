@@ -0,0 +1,253 @@
+#include <bit>
+#include <cstring>
+#include <thread>
+
+#include "gpwe/AsyncLog.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// write out a batch once it grows this big, even if more is pending
+	constexpr std::size_t maxBatchSize = 64 * 1024;
+}
+
+log::AsyncManager::AsyncManager(AsyncConfig config)
+	: m_config(std::move(config))
+	, m_mask(std::bit_ceil(std::max<std::size_t>(m_config.capacity, 2)) - 1)
+{
+	sys::MemoryTagScope tag(ManagerKind::log);
+
+	setHistorySize(m_config.historySize);
+
+	m_slots = reinterpret_cast<Slot*>(sys::defaultResource()->allocate(sizeof(Slot) * (m_mask + 1), 64));
+
+	for(std::size_t i = 0; i <= m_mask; i++){
+		new(m_slots + i) Slot;
+		m_slots[i].seq.store(i, std::memory_order_relaxed);
+	}
+
+	m_outBuf.reserve(maxBatchSize);
+	m_errBuf.reserve(maxBatchSize);
+
+	if(!m_config.path.empty() && !openFile()){
+		std::fprintf(stderr, "Could not open log file '%s', logging to stdout\n", m_config.path.c_str());
+		m_config.path.clear();
+	}
+
+	m_writer = makeUnique<Thread>([this]{ writerFn(); });
+	m_writer->setName("gpwe-log");
+}
+
+log::AsyncManager::~AsyncManager(){
+	m_stop = true;
+	wakeWriter();
+	m_writer.reset();
+
+	if(m_file){
+		std::fclose(m_file);
+	}
+
+	for(std::size_t i = 0; i <= m_mask; i++){
+		m_slots[i].~Slot();
+	}
+
+	sys::defaultResource()->deallocate(m_slots, sizeof(Slot) * (m_mask + 1), 64);
+}
+
+void log::AsyncManager::submit(Kind kind, StrView str){
+	const auto capacity = m_mask + 1;
+
+	auto pos = m_tail.load(std::memory_order_relaxed);
+	Slot *slot;
+
+	while(true){
+		slot = m_slots + (pos & m_mask);
+
+		const auto seq = slot->seq.load(std::memory_order_acquire);
+		const auto diff = std::intptr_t(seq) - std::intptr_t(pos);
+
+		if(diff == 0){
+			if(m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+				break;
+			}
+		}
+		else if(diff < 0){
+			if(m_config.overflow == OverflowPolicy::drop){
+				m_numDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			wakeWriter();
+			std::this_thread::yield();
+			pos = m_tail.load(std::memory_order_relaxed);
+		}
+		else{
+			pos = m_tail.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->time = Clock::now();
+	slot->kind = kind;
+	slot->len = Nat32(str.size());
+
+	if(str.size() <= sizeof(slot->text)){
+		slot->heap = nullptr;
+		std::memcpy(slot->text, str.data(), str.size());
+	}
+	else{
+		sys::MemoryTagScope tag(ManagerKind::log);
+		slot->heap = reinterpret_cast<char*>(sys::alloc(str.size()));
+		std::memcpy(slot->heap, str.data(), str.size());
+	}
+
+	slot->seq.store(pos + 1, std::memory_order_release);
+
+	// let the writer batch up unless something needs to go out now
+	if(kind == Kind::error || (pos - m_written.load(std::memory_order_relaxed)) >= capacity / 2){
+		wakeWriter();
+	}
+}
+
+void log::AsyncManager::wakeWriter(){
+	m_wake.store(true);
+
+	if(m_sleeping.load()){
+		std::lock_guard lock(m_mut);
+		m_cv.notify_one();
+	}
+}
+
+void log::AsyncManager::flush(){
+	const auto target = m_tail.load(std::memory_order_acquire);
+
+	while(true){
+		const auto written = m_written.load(std::memory_order_acquire);
+		if(written >= target) break;
+
+		wakeWriter();
+		m_written.wait(written, std::memory_order_acquire);
+	}
+}
+
+void log::AsyncManager::writerFn(){
+	while(true){
+		{
+			std::unique_lock lock(m_mut);
+			m_sleeping.store(true);
+			m_cv.wait_for(lock, m_config.flushInterval, [this]{ return m_wake.load() || m_stop.load(); });
+			m_sleeping.store(false);
+			m_wake.store(false);
+		}
+
+		const bool stopping = m_stop.load();
+
+		while(writePending() > 0){}
+
+		if(stopping) break;
+	}
+}
+
+std::size_t log::AsyncManager::writePending(){
+	std::size_t n = 0;
+
+	const auto numDropped = m_numDropped.load(std::memory_order_relaxed);
+	if(numDropped != m_numDroppedReported){
+		auto &&buf = m_config.path.empty() ? m_errBuf : m_outBuf;
+		formatTo<"log ring full, dropped {} messages\n">(buf, numDropped - m_numDroppedReported);
+		m_numDroppedReported = numDropped;
+	}
+
+	while(m_outBuf.size() + m_errBuf.size() < maxBatchSize){
+		auto slot = m_slots + (m_head & m_mask);
+
+		if(slot->seq.load(std::memory_order_acquire) != (m_head + 1)){
+			break;
+		}
+
+		const StrView text(slot->heap ? slot->heap : slot->text, slot->len);
+
+		// stdout and stderr keep the split the synchronous log uses
+		const bool toErr = m_config.path.empty() && slot->kind != Kind::info;
+		(toErr ? m_errBuf : m_outBuf) += text;
+
+		remember(slot->time, slot->kind, text);
+
+		if(slot->heap){
+			sys::free(slot->heap);
+		}
+
+		slot->seq.store(m_head + m_mask + 1, std::memory_order_release);
+		++m_head;
+		++n;
+	}
+
+	if(m_file){
+		writeOut(m_file, m_outBuf);
+	}
+	else{
+		writeOut(stdout, m_outBuf);
+		writeOut(stderr, m_errBuf);
+	}
+
+	if(n){
+		m_written.store(m_head, std::memory_order_release);
+		m_written.notify_all();
+	}
+
+	return n;
+}
+
+void log::AsyncManager::writeOut(std::FILE *fd, Str &buf){
+	if(buf.empty()) return;
+
+	if(fd == m_file && m_config.maxFileSize && m_fileSize > 0 && (m_fileSize + buf.size()) > m_config.maxFileSize){
+		rotate();
+		fd = m_file;
+	}
+
+	if(fd){
+		std::fwrite(buf.data(), 1, buf.size(), fd);
+		std::fflush(fd);
+	}
+
+	if(fd == m_file){
+		m_fileSize += buf.size();
+	}
+
+	buf.clear();
+}
+
+bool log::AsyncManager::openFile(){
+	m_file = std::fopen(m_config.path.c_str(), "ab");
+	if(!m_file) return false;
+
+	std::fseek(m_file, 0, SEEK_END);
+	m_fileSize = std::size_t(std::max(std::ftell(m_file), 0L));
+	return true;
+}
+
+void log::AsyncManager::rotate(){
+	std::fclose(m_file);
+	m_file = nullptr;
+
+	const auto &path = m_config.path;
+	auto numbered = [&path](Nat32 i){ return path + "." + std::to_string(i).c_str(); };
+
+	if(m_config.maxFiles > 0){
+		std::remove(numbered(m_config.maxFiles).c_str());
+
+		for(auto i = m_config.maxFiles; i > 1; i--){
+			std::rename(numbered(i - 1).c_str(), numbered(i).c_str());
+		}
+
+		std::rename(path.c_str(), numbered(1).c_str());
+	}
+	else{
+		std::remove(path.c_str());
+	}
+
+	if(!openFile()){
+		// can't log about it through ourselves, the writer would wait on itself
+		std::fprintf(stderr, "Could not reopen log file '%s' after rotating\n", path.c_str());
+	}
+}
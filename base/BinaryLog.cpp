@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <bit>
+
+#if __has_include("fmt/args.h")
+#include "fmt/args.h"
+#endif
+
+#include "gpwe/BinaryLog.hpp"
+
+using namespace gpwe;
+
+struct log::detail::BinaryBuffer{
+	std::byte *data;
+	std::size_t mask;
+	log::BinaryLog *owner;
+	std::atomic_bool alive = true;
+
+	// padded rather than aligned, buffers are heap allocated
+	char pad0[64];
+	std::atomic<std::size_t> tail = 0;
+	std::size_t cachedHead = 0;
+	char pad1[64 - sizeof(std::atomic<std::size_t>) - sizeof(std::size_t)];
+	std::atomic<std::size_t> head = 0;
+};
+
+namespace {
+	std::mutex g_sitesMut;
+	Vector<const char*> g_sites;
+
+	std::atomic<log::BinaryLog*> g_active = nullptr;
+	std::atomic<Nat64> g_activeGen = 0;
+	Nat64 g_numLogs = 0;
+
+	struct ThreadBuffer{
+		~ThreadBuffer(){
+			// the log may have been replaced since, then the buffer is already gone
+			if(buf && gen == g_activeGen.load(std::memory_order_acquire)){
+				buf->alive.store(false, std::memory_order_release);
+			}
+		}
+
+		Nat64 gen = 0;
+		log::detail::BinaryBuffer *buf = nullptr;
+	};
+
+	thread_local ThreadBuffer t_buffer;
+
+	template<typename T>
+	T readRaw(const std::byte *p) noexcept{
+		T ret;
+		std::memcpy(&ret, p, sizeof(T));
+		return ret;
+	}
+}
+
+Nat32 log::detail::registerBinarySite(const char *fmt){
+	sys::MemoryTagScope tag(ManagerKind::log);
+	std::lock_guard lock(g_sitesMut);
+	g_sites.emplace_back(fmt);
+	return Nat32(g_sites.size() - 1);
+}
+
+log::detail::BinaryBuffer *log::detail::binaryBuffer(){
+	const auto binLog = g_active.load(std::memory_order_acquire);
+	if(!binLog) return nullptr;
+
+	if(t_buffer.gen != binLog->m_gen){
+		t_buffer.buf = binLog->addBuffer();
+		t_buffer.gen = binLog->m_gen;
+	}
+
+	return t_buffer.buf;
+}
+
+std::byte *log::detail::binaryReserve(BinaryBuffer *buf, std::size_t size) noexcept{
+	const auto capacity = buf->mask + 1;
+
+	if(size > std::min<std::size_t>(capacity / 2, 0xfff8)){
+		buf->owner->m_numDropped.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	const auto tail = buf->tail.load(std::memory_order_relaxed);
+	const auto offset = tail & buf->mask;
+	const auto toEnd = capacity - offset;
+
+	// records never straddle the end, a short tail is skipped with a wrap marker
+	const auto needed = toEnd < size ? toEnd + size : size;
+
+	if(tail + needed - buf->cachedHead > capacity){
+		buf->cachedHead = buf->head.load(std::memory_order_acquire);
+
+		if(tail + needed - buf->cachedHead > capacity){
+			buf->owner->m_numDropped.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+	}
+
+	if(toEnd < size){
+		const Nat16 wrap = 0;
+		std::memcpy(buf->data + offset, &wrap, sizeof(wrap));
+		buf->tail.store(tail + toEnd, std::memory_order_release);
+		return buf->data;
+	}
+
+	return buf->data + offset;
+}
+
+void log::detail::binaryCommit(BinaryBuffer *buf, std::size_t size) noexcept{
+	const auto tail = buf->tail.load(std::memory_order_relaxed) + size;
+	buf->tail.store(tail, std::memory_order_release);
+
+	// the cached head is stale more often than not, only look at the real one past half full
+	const auto half = (buf->mask + 1) / 2;
+
+	if(tail - buf->cachedHead > half){
+		buf->cachedHead = buf->head.load(std::memory_order_acquire);
+
+		if(tail - buf->cachedHead > half){
+			buf->owner->wakeWriter();
+		}
+	}
+}
+
+bool log::decodeBinaryRecord(Str &out, const char *fmt, const BinaryRecord *record){
+	fmt::dynamic_format_arg_store<fmt::format_context> store;
+	store.reserve(record->numArgs, 0);
+
+	auto it = reinterpret_cast<const std::byte*>(record) + sizeof(BinaryRecord);
+	const auto end = reinterpret_cast<const std::byte*>(record) + record->size;
+
+	for(Nat8 i = 0; i < record->numArgs; i++){
+		if(it + 1 + sizeof(Nat64) > end) return false;
+
+		const auto type = ArgType(*it++);
+
+		switch(type){
+			case ArgType::int_: store.push_back(readRaw<Int64>(it)); break;
+			case ArgType::uint: store.push_back(readRaw<Nat64>(it)); break;
+			case ArgType::float_: store.push_back(readRaw<double>(it)); break;
+			case ArgType::bool_: store.push_back(readRaw<Nat64>(it) != 0); break;
+			case ArgType::char_: store.push_back(char(readRaw<Nat64>(it))); break;
+			case ArgType::ptr: store.push_back(reinterpret_cast<const void*>(std::uintptr_t(readRaw<Nat64>(it)))); break;
+
+			case ArgType::str:{
+				const auto len = readRaw<Nat32>(it);
+				it += sizeof(Nat32);
+				if(it + len > end) return false;
+
+				// the store copies, records are recycled once written
+				store.push_back(fmt::string_view(reinterpret_cast<const char*>(it), len));
+				it += len;
+				continue;
+			}
+
+			default: return false;
+		}
+
+		it += sizeof(Nat64);
+	}
+
+	try{
+		fmt::vformat_to(std::back_inserter(out), fmt::string_view(fmt), store);
+	}
+	catch(const fmt::format_error&){
+		return false;
+	}
+
+	return true;
+}
+
+log::BinaryLog::BinaryLog(BinaryConfig config)
+	: m_config(std::move(config))
+	, m_logManager(m_config.logManager ? m_config.logManager : sys::logManager())
+{
+	sys::MemoryTagScope tag(ManagerKind::log);
+
+	if(!m_config.path.empty()){
+		m_file = std::fopen(m_config.path.c_str(), "wb");
+
+		if(m_file){
+			std::fwrite(fileMagic, 1, sizeof(fileMagic), m_file);
+			std::fwrite(&fileVersion, sizeof(fileVersion), 1, m_file);
+		}
+		else{
+			log::errorLn("Could not open binary log '{}', formatting into the log instead", m_config.path);
+			m_config.path.clear();
+		}
+	}
+
+	m_gen = ++g_numLogs;
+
+	log::BinaryLog *expected = nullptr;
+	if(!g_active.compare_exchange_strong(expected, this)){
+		log::errorLn("A binary log is already running, this one will stay empty");
+	}
+	else{
+		g_activeGen.store(m_gen, std::memory_order_release);
+	}
+
+	m_writer = makeUnique<Thread>([this]{ writerFn(); });
+	m_writer->setName("gpwe-binlog");
+}
+
+log::BinaryLog::~BinaryLog(){
+	log::BinaryLog *expected = this;
+	if(g_active.compare_exchange_strong(expected, nullptr)){
+		g_activeGen.store(0, std::memory_order_release);
+	}
+
+	{
+		std::lock_guard lock(m_mut);
+		m_stop = true;
+	}
+
+	m_cv.notify_all();
+	m_writer.reset();
+
+	if(m_file){
+		std::fclose(m_file);
+	}
+
+	for(auto buf : m_buffers){
+		sys::defaultResource()->deallocate(buf->data, buf->mask + 1, 64);
+		buf->~BinaryBuffer();
+		sys::free(buf);
+	}
+}
+
+log::detail::BinaryBuffer *log::BinaryLog::addBuffer(){
+	sys::MemoryTagScope tag(ManagerKind::log);
+
+	const auto size = std::bit_ceil(std::max<std::size_t>(m_config.bufferSize, 1024));
+
+	auto buf = new(sys::alloc(sizeof(detail::BinaryBuffer))) detail::BinaryBuffer;
+	buf->data = reinterpret_cast<std::byte*>(sys::defaultResource()->allocate(size, 64));
+	buf->mask = size - 1;
+	buf->owner = this;
+
+	std::lock_guard lock(m_buffersMut);
+	m_buffers.emplace_back(buf);
+	return buf;
+}
+
+void log::BinaryLog::wakeWriter() noexcept{
+	if(m_wake.exchange(true)) return;
+
+	if(m_sleeping.load()){
+		std::lock_guard lock(m_mut);
+		m_cv.notify_all();
+	}
+}
+
+void log::BinaryLog::flush(){
+	std::unique_lock lock(m_mut);
+	const auto target = ++m_flushRequests;
+	m_cv.notify_all();
+	m_cv.wait(lock, [this, target]{ return m_flushesDone >= target; });
+}
+
+void log::BinaryLog::writerFn(){
+	while(true){
+		Nat64 requests;
+		bool stopping;
+
+		{
+			std::unique_lock lock(m_mut);
+			m_sleeping.store(true);
+			m_cv.wait_for(lock, m_config.flushInterval, [this]{ return m_wake.load() || m_stop || m_flushRequests != m_flushesDone; });
+			m_sleeping.store(false);
+			m_wake.store(false);
+			requests = m_flushRequests;
+			stopping = m_stop;
+		}
+
+		while(writePending()){}
+
+		const auto numDropped = m_numDropped.load(std::memory_order_relaxed);
+		if(numDropped != m_numDroppedReported){
+			m_logManager->logWarnLn("Binary log buffers full, dropped {} records", numDropped - m_numDroppedReported);
+			m_numDroppedReported = numDropped;
+		}
+
+		if(m_file){
+			std::fflush(m_file);
+		}
+
+		reapBuffers();
+
+		{
+			std::lock_guard lock(m_mut);
+			m_flushesDone = requests;
+		}
+
+		m_cv.notify_all();
+
+		if(stopping) break;
+	}
+}
+
+bool log::BinaryLog::writePending(){
+	{
+		std::lock_guard lock(m_buffersMut);
+		m_snapshot.assign(m_buffers.begin(), m_buffers.end());
+	}
+
+	m_pending.clear();
+	m_tails.clear();
+
+	for(auto buf : m_snapshot){
+		const auto capacity = buf->mask + 1;
+		const auto tail = buf->tail.load(std::memory_order_acquire);
+		m_tails.emplace_back(tail);
+		auto pos = buf->head.load(std::memory_order_relaxed);
+
+		while(pos != tail){
+			const auto offset = pos & buf->mask;
+			auto record = reinterpret_cast<const BinaryRecord*>(buf->data + offset);
+
+			if(record->size == 0){
+				pos += capacity - offset;
+				continue;
+			}
+
+			m_pending.emplace_back(record);
+			pos += record->size;
+		}
+	}
+
+	if(m_pending.empty()) return false;
+
+	// each buffer is already in order, this only interleaves threads within a batch
+	std::stable_sort(m_pending.begin(), m_pending.end(), [](auto lhs, auto rhs){ return lhs->time < rhs->time; });
+
+	for(auto record : m_pending){
+		writeRecord(record);
+	}
+
+	// everything up to the tails seen above has been written, hand the space back
+	for(std::size_t i = 0; i < m_snapshot.size(); i++){
+		m_snapshot[i]->head.store(m_tails[i], std::memory_order_release);
+	}
+
+	return true;
+}
+
+void log::BinaryLog::writeRecord(const BinaryRecord *record){
+	if(record->site >= m_sites.size()){
+		std::lock_guard lock(g_sitesMut);
+		m_sites.assign(g_sites.begin(), g_sites.end());
+	}
+
+	if(m_file){
+		for(; m_numSitesWritten < m_sites.size(); m_numSitesWritten++){
+			const auto fmt = m_sites[m_numSitesWritten];
+			const auto len = Nat32(std::strlen(fmt));
+			const auto chunk = Chunk::site;
+
+			std::fwrite(&chunk, sizeof(chunk), 1, m_file);
+			std::fwrite(&m_numSitesWritten, sizeof(Nat32), 1, m_file);
+			std::fwrite(&len, sizeof(len), 1, m_file);
+			std::fwrite(fmt, 1, len, m_file);
+		}
+
+		const auto chunk = Chunk::record;
+		std::fwrite(&chunk, sizeof(chunk), 1, m_file);
+		std::fwrite(record, 1, record->size, m_file);
+		return;
+	}
+
+	m_line.clear();
+
+	if(!decodeBinaryRecord(m_line, m_sites[record->site], record)){
+		m_logManager->logErrorLn("Malformed binary log record for '{}'", m_sites[record->site]);
+		return;
+	}
+
+	m_logManager->logLn(Kind(record->kind), "{}", m_line);
+}
+
+void log::BinaryLog::reapBuffers(){
+	std::lock_guard lock(m_buffersMut);
+
+	std::erase_if(m_buffers, [](auto buf){
+		if(buf->alive.load(std::memory_order_acquire) || buf->head.load() != buf->tail.load()){
+			return false;
+		}
+
+		sys::defaultResource()->deallocate(buf->data, buf->mask + 1, 64);
+		buf->~BinaryBuffer();
+		sys::free(buf);
+		return true;
+	});
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "gpwe/util/FramePacer.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// sleeps this close to the deadline aren't worth the wake up
+	constexpr auto minSleep = std::chrono::microseconds(200);
+
+	constexpr auto minJitter = std::chrono::microseconds(50);
+	constexpr auto maxJitter = std::chrono::milliseconds(4);
+
+	template<typename Dur>
+	inline void smooth(Dur &avg, Dur sample, int weight) noexcept{
+		avg += (sample - avg) / weight;
+	}
+}
+
+FramePacer::FramePacer(float targetFps){
+	const auto now = Clock::now();
+	m_lastWaitEnd = m_deadline = m_lastDirty = now;
+
+	setTargetFps(targetFps);
+}
+
+FramePacer::Duration FramePacer::periodFor(float fps) noexcept{
+	if(!(fps > 0.f)) return Duration::zero();
+	return Duration(std::llround(1e9 / fps));
+}
+
+void FramePacer::setTargetFps(float fps) noexcept{
+	m_targetFps = std::max(fps, 0.f);
+	m_period = periodFor(m_targetFps);
+}
+
+void FramePacer::setIdleFps(float fps) noexcept{
+	m_idleFps = std::max(fps, 0.f);
+	m_idlePeriod = periodFor(m_idleFps);
+}
+
+void FramePacer::markDirty() noexcept{
+	m_dirty.store(true);
+
+	// only bother with the lock when an idle wait might be asleep
+	if(m_sleeping.load()){
+		std::lock_guard lock(m_mut);
+		m_cv.notify_all();
+	}
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline){
+	while(true){
+		const auto now = Clock::now();
+		const auto remaining = deadline - now;
+
+		if(remaining <= m_jitter + minSleep) break;
+
+		const auto request = std::chrono::duration_cast<Duration>(remaining - m_jitter);
+		std::this_thread::sleep_for(request);
+
+		// rise quickly when sleeps get worse, settle slowly when they improve
+		const auto over = std::chrono::duration_cast<Duration>(Clock::now() - now) - request;
+		smooth(m_jitter, over, over > m_jitter ? 4 : 32);
+		m_jitter = std::clamp<Duration>(m_jitter, minJitter, maxJitter);
+	}
+
+	while(Clock::now() < deadline){
+		std::this_thread::yield();
+	}
+}
+
+void FramePacer::idleUntil(Clock::time_point deadline){
+	std::unique_lock lock(m_mut);
+	m_sleeping.store(true);
+	m_cv.wait_until(lock, deadline, [this]{ return m_dirty.load(); });
+	m_sleeping.store(false);
+}
+
+void FramePacer::wait(){
+	const auto start = Clock::now();
+
+	if(m_dirty.exchange(false)){
+		m_lastDirty = start;
+	}
+
+	const bool idle = m_idlePeriod > Duration::zero() && (start - m_lastDirty) >= m_idleDelay;
+	const auto period = idle ? std::max(m_idlePeriod, m_period) : m_period;
+	const auto work = std::chrono::duration_cast<Duration>(start - m_lastWaitEnd);
+
+	if(period > Duration::zero()){
+		m_deadline += period;
+
+		// more than a frame behind, start the schedule over rather than rushing to catch up
+		if(m_deadline + period < start){
+			m_deadline = start;
+		}
+
+		if(idle){
+			idleUntil(m_deadline);
+		}
+		else{
+			sleepUntil(m_deadline);
+		}
+	}
+
+	const auto end = Clock::now();
+
+	// woken early or pacing off, the next frame is timed from now
+	if(end < m_deadline || period == Duration::zero()){
+		m_deadline = end;
+	}
+
+	m_last = FrameTiming{
+		period, work,
+		period > Duration::zero() ? period - work : Duration::zero(),
+		std::chrono::duration_cast<Duration>(end - start),
+		idle
+	};
+
+	smooth(m_avgSlack, m_last.slack, 16);
+	smooth(m_avgWork, work, 16);
+
+	m_lastWaitEnd = end;
+	m_idle = idle;
+}
@@ -0,0 +1,106 @@
+#include "gpwe/util/FrameStats.hpp"
+
+using namespace gpwe;
+
+namespace {
+	FrameStats::Summary summarize(const Histogram &hist, Nat64 max){
+		using Duration = FrameStats::Duration;
+
+		// buckets report their upper bound, which can overshoot the real max
+		auto percentile = [&](double p){ return Duration(std::min(hist.percentile(p), max)); };
+
+		return FrameStats::Summary{
+			percentile(50.0), percentile(95.0), percentile(99.0),
+			Duration(max),
+			std::size_t(hist.count())
+		};
+	}
+}
+
+StrView FrameStats::stageName(Stage stage) noexcept{
+	switch(stage){
+		case Stage::frame: return "frame";
+		case Stage::input: return "input";
+		case Stage::app: return "app";
+		case Stage::physics: return "physics";
+		case Stage::render: return "render";
+		case Stage::present: return "present";
+		default: return "unknown";
+	}
+}
+
+FrameStats::FrameStats(std::size_t window_){
+	setWindow(window_);
+}
+
+void FrameStats::setWindow(std::size_t frames){
+	std::lock_guard lock(m_mut);
+
+	for(auto &&hist : m_hists){
+		hist.setWindow(frames);
+	}
+
+	for(std::size_t i = 0; i < numStages; i++){
+		m_totals[i].reset();
+		m_totalMax[i] = 0;
+	}
+
+	m_lastFrame = {};
+}
+
+std::size_t FrameStats::window() const noexcept{
+	return m_hists[0].window();
+}
+
+void FrameStats::endFrame() noexcept{
+	const auto now = Clock::now();
+
+	std::lock_guard lock(m_mut);
+
+	// the first call only starts the clock, there's no frame before it
+	if(m_lastFrame != Clock::time_point{}){
+		m_pending[std::size_t(Stage::frame)].store(Nat64(Duration(now - m_lastFrame).count()), std::memory_order_relaxed);
+
+		for(std::size_t i = 0; i < numStages; i++){
+			const auto dur = m_pending[i].exchange(0, std::memory_order_relaxed);
+			m_hists[i].record(dur);
+			m_totals[i].record(dur);
+			m_totalMax[i] = std::max(m_totalMax[i], dur);
+		}
+	}
+	else{
+		for(auto &&pending : m_pending){
+			pending.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	m_lastFrame = now;
+}
+
+FrameStats::Summary FrameStats::summary(Stage stage) const{
+	std::lock_guard lock(m_mut);
+
+	auto &&hist = m_hists[std::size_t(stage)];
+	return summarize(hist.histogram(), hist.max());
+}
+
+FrameStats::Summary FrameStats::totalSummary(Stage stage) const{
+	std::lock_guard lock(m_mut);
+	return summarize(m_totals[std::size_t(stage)], m_totalMax[std::size_t(stage)]);
+}
+
+Str FrameStats::report() const{
+	auto ms = [](Duration dur){ return std::chrono::duration<double, std::milli>(dur).count(); };
+
+	Str out;
+	formatTo<"frame stats over {} frames (ms)\n{:<10}{:>9}{:>9}{:>9}{:>9}">(out, summary(Stage::frame).numFrames, "stage", "p50", "p95", "p99", "max");
+
+	for(std::size_t i = 0; i < numStages; i++){
+		const auto stage = Stage(i);
+		const auto sum = summary(stage);
+
+		formatTo<"\n{:<10}{:>9.3f}{:>9.3f}{:>9.3f}{:>9.3f}">(out, stageName(stage), ms(sum.p50), ms(sum.p95), ms(sum.p99), ms(sum.max));
+	}
+
+	return out;
+}
@@ -0,0 +1,375 @@
+#include "gpwe/log.hpp"
+#include "gpwe/util/JobSystem.hpp"
+
+using namespace gpwe;
+
+struct JobSystem::Job{
+	JobFn fn;
+	JobCounter *counter;
+};
+
+/*
+ * Chase-Lev work-stealing deque
+ *
+ * The owner pushes and pops at the bottom, thieves take from the top. Only
+ * the last element is contended, which is settled with a CAS on top.
+ * Orderings follow Le et al. "Correct and Efficient Work-Stealing for Weak
+ * Memory Models". Retired arrays are kept until the deque dies, a thief may
+ * still be reading one.
+ */
+class JobSystem::Deque{
+	public:
+		Deque(){
+			m_array.store(newArray(256), std::memory_order_relaxed);
+		}
+
+		~Deque(){
+			auto array = m_array.load(std::memory_order_relaxed);
+			while(array){
+				auto prev = array->prev;
+				sys::free(array);
+				array = prev;
+			}
+		}
+
+		bool empty() const noexcept{
+			const auto b = m_bottom.load(std::memory_order_relaxed);
+			const auto t = m_top.load(std::memory_order_relaxed);
+			return b <= t;
+		}
+
+		void push(Job *job){
+			const auto b = m_bottom.load(std::memory_order_relaxed);
+			const auto t = m_top.load(std::memory_order_acquire);
+			auto array = m_array.load(std::memory_order_relaxed);
+
+			if((b - t) > std::int64_t(array->mask)){
+				array = grow(array, b, t);
+			}
+
+			array->slot(b).store(job, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		Job *pop() noexcept{
+			const auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+			auto array = m_array.load(std::memory_order_relaxed);
+			m_bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto t = m_top.load(std::memory_order_relaxed);
+
+			if(t > b){
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			auto job = array->slot(b).load(std::memory_order_relaxed);
+
+			if(t == b){
+				// last one, race any thieves for it
+				if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+					job = nullptr;
+				}
+
+				m_bottom.store(b + 1, std::memory_order_relaxed);
+			}
+
+			return job;
+		}
+
+		Job *steal() noexcept{
+			auto t = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const auto b = m_bottom.load(std::memory_order_acquire);
+
+			if(t >= b) return nullptr;
+
+			auto array = m_array.load(std::memory_order_acquire);
+			auto job = array->slot(t).load(std::memory_order_relaxed);
+
+			if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+				return nullptr;
+			}
+
+			return job;
+		}
+
+	private:
+		struct Array{
+			Array *prev;
+			std::size_t mask;
+
+			std::atomic<Job*> &slot(std::int64_t idx) noexcept{
+				return reinterpret_cast<std::atomic<Job*>*>(this + 1)[idx & mask];
+			}
+		};
+
+		static Array *newArray(std::size_t capacity){
+			auto mem = sys::alloc(sizeof(Array) + (sizeof(std::atomic<Job*>) * capacity));
+			auto array = new(mem) Array{ nullptr, capacity - 1 };
+
+			for(std::size_t i = 0; i < capacity; i++){
+				new(&array->slot(i)) std::atomic<Job*>(nullptr);
+			}
+
+			return array;
+		}
+
+		Array *grow(Array *array, std::int64_t b, std::int64_t t){
+			auto bigger = newArray((array->mask + 1) * 2);
+			bigger->prev = array;
+
+			for(auto i = t; i < b; i++){
+				bigger->slot(i).store(array->slot(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+
+			m_array.store(bigger, std::memory_order_release);
+			return bigger;
+		}
+
+		alignas(64) std::atomic<std::int64_t> m_top = 0;
+		alignas(64) std::atomic<std::int64_t> m_bottom = 0;
+		std::atomic<Array*> m_array;
+};
+
+struct JobSystem::Worker{
+	JobSystem *jobs;
+	Deque deques[(std::size_t)JobPriority::count];
+	Nat32 rng;
+	UniquePtr<Thread> thread; // Thread hands its own address to pthread, so it can't move once started
+};
+
+namespace {
+	thread_local void *tlWorker = nullptr;
+
+	constexpr std::size_t numSpins = 64;
+
+	inline void cpuRelax() noexcept{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+	}
+}
+
+JobSystem::JobSystem(std::size_t numWorkers){
+	m_workers.reserve(numWorkers);
+
+	for(std::size_t i = 0; i < numWorkers; i++){
+		auto mem = sys::defaultResource()->allocate(sizeof(Worker), alignof(Worker));
+		auto worker = new(mem) Worker{ this, {}, Nat32(i * 2654435761u + 1), nullptr };
+		m_workers.emplace_back(worker);
+	}
+
+	// only start once every worker exists, they steal from each other
+	for(std::size_t i = 0; i < numWorkers; i++){
+		auto worker = m_workers[i];
+		worker->thread = makeUnique<Thread>([this, worker]{ workerFn(worker); });
+		worker->thread->setName(format("gpwe-job{}", i));
+	}
+}
+
+JobSystem::~JobSystem(){
+	{
+		std::lock_guard lock(m_sleepMut);
+		m_running = false;
+	}
+
+	m_sleepCond.notify_all();
+
+	for(auto worker : m_workers){
+		worker->thread->join();
+	}
+
+	// finish whatever was left so counters and captures are released
+	while(auto job = findJob(nullptr)){
+		execute(job);
+	}
+
+	for(auto worker : m_workers){
+		worker->~Worker();
+		sys::defaultResource()->deallocate(worker, sizeof(Worker), alignof(Worker));
+	}
+}
+
+void JobSystem::run(JobFn fn, JobCounter *counter, JobPriority prio){
+	auto job = new(sys::alloc(sizeof(Job))) Job{ std::move(fn), counter };
+
+	if(counter){
+		counter->m_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const auto prioIdx = std::size_t(prio);
+	auto self = reinterpret_cast<Worker*>(tlWorker);
+
+	if(self && self->jobs == this){
+		self->deques[prioIdx].push(job);
+	}
+	else{
+		std::lock_guard lock(m_injectMut);
+		m_injected[prioIdx].emplace_back(job);
+	}
+
+	m_numQueued.fetch_add(1, std::memory_order_seq_cst);
+	wake();
+}
+
+void JobSystem::wake() noexcept{
+	if(m_numSleeping.load(std::memory_order_seq_cst) > 0){
+		std::lock_guard lock(m_sleepMut);
+		m_sleepCond.notify_one();
+	}
+}
+
+JobSystem::Job *JobSystem::popInjected() noexcept{
+	std::lock_guard lock(m_injectMut);
+
+	for(std::size_t p = 0; p < std::size(m_injected); p++){
+		auto &&queue = m_injected[p];
+		auto &&head = m_injectedHead[p];
+
+		if(head < queue.size()){
+			auto job = queue[head++];
+
+			if(head == queue.size()){
+				queue.clear();
+				head = 0;
+			}
+
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+JobSystem::Job *JobSystem::stealJob(Worker *self) noexcept{
+	const auto numWorkers = m_workers.size();
+	if(!numWorkers) return nullptr;
+
+	Nat32 start = 0;
+	if(self){
+		self->rng ^= self->rng << 13;
+		self->rng ^= self->rng >> 17;
+		self->rng ^= self->rng << 5;
+		start = self->rng;
+	}
+
+	for(std::size_t p = 0; p < std::size_t(JobPriority::count); p++){
+		for(std::size_t i = 0; i < numWorkers; i++){
+			auto victim = m_workers[(start + i) % numWorkers];
+			if(victim == self) continue;
+
+			if(auto job = victim->deques[p].steal()){
+				return job;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+JobSystem::Job *JobSystem::findJob(Worker *self) noexcept{
+	Job *job = nullptr;
+
+	if(self){
+		for(auto &&deque : self->deques){
+			if((job = deque.pop())) break;
+		}
+	}
+
+	if(!job) job = popInjected();
+	if(!job) job = stealJob(self);
+
+	if(job){
+		m_numQueued.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+void JobSystem::execute(Job *job) noexcept{
+	try{
+		job->fn();
+	}
+	catch(const std::exception &err){
+		log::errorLn("Uncaught exception in job: {}", err.what());
+	}
+	catch(...){
+		log::errorLn("Uncaught exception in job");
+	}
+
+	auto counter = job->counter;
+
+	job->~Job();
+	sys::free(job);
+
+	if(counter){
+		counter->m_count.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+bool JobSystem::runOne(){
+	auto self = reinterpret_cast<Worker*>(tlWorker);
+	if(self && self->jobs != this){
+		self = nullptr;
+	}
+
+	if(auto job = findJob(self)){
+		execute(job);
+		return true;
+	}
+
+	return false;
+}
+
+void JobSystem::wait(const JobCounter &counter){
+	std::size_t idle = 0;
+
+	while(!counter.done()){
+		if(runOne()){
+			idle = 0;
+		}
+		else if(++idle < numSpins){
+			cpuRelax();
+		}
+		else{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::workerFn(Worker *self){
+	tlWorker = self;
+
+	// jobs run inside the frame, keep their allocation latency bounded too
+	sys::enableRealtimeHeap();
+
+	while(m_running.load(std::memory_order_relaxed)){
+		if(auto job = findJob(self)){
+			execute(job);
+			continue;
+		}
+
+		bool found = false;
+		for(std::size_t i = 0; i < numSpins && !found; i++){
+			cpuRelax();
+			found = m_numQueued.load(std::memory_order_relaxed) > 0;
+		}
+
+		if(found) continue;
+
+		std::unique_lock lock(m_sleepMut);
+		m_numSleeping.fetch_add(1, std::memory_order_seq_cst);
+
+		m_sleepCond.wait(lock, [this]{
+			return !m_running.load(std::memory_order_relaxed) || m_numQueued.load(std::memory_order_seq_cst) > 0;
+		});
+
+		m_numSleeping.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	sys::disableRealtimeHeap();
+
+	tlWorker = nullptr;
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include "gpwe/util/MemoryResource.hpp"
+
+using namespace gpwe;
+
+namespace {
+	constexpr std::size_t maxArenaBlockSize = 4 * 1024 * 1024;
+}
+
+ArenaResource::ArenaResource(std::size_t blockSize, MemoryResource *upstream) noexcept
+	: m_upstream(upstream)
+	, m_blockSize(std::max(blockSize, sizeof(Block) * 2))
+	, m_nextBlockSize(m_blockSize)
+{}
+
+ArenaResource::~ArenaResource(){
+	release();
+}
+
+void ArenaResource::release() noexcept{
+	auto block = m_blocks;
+	while(block){
+		auto next = block->next;
+		m_upstream->deallocate(block, block->size, alignof(Block));
+		block = next;
+	}
+
+	m_blocks = nullptr;
+	m_cur = m_end = nullptr;
+	m_nextBlockSize = m_blockSize;
+	m_used = m_reserved = 0;
+}
+
+void *ArenaResource::doAllocate(std::size_t n, std::size_t align){
+	auto alignUp = [align](char *p){
+		const auto addr = reinterpret_cast<std::uintptr_t>(p);
+		return reinterpret_cast<char*>((addr + (align - 1)) & ~std::uintptr_t(align - 1));
+	};
+
+	auto ptr = alignUp(m_cur);
+
+	if(!m_cur || (ptr + n) > m_end){
+		// blocks grow geometrically so big arenas don't take thousands of trips upstream
+		const auto need = sizeof(Block) + n + align;
+		const auto size = std::max(need, m_nextBlockSize);
+
+		auto block = reinterpret_cast<Block*>(m_upstream->allocate(size, alignof(Block)));
+		block->next = m_blocks;
+		block->size = size;
+		m_blocks = block;
+
+		m_cur = reinterpret_cast<char*>(block + 1);
+		m_end = reinterpret_cast<char*>(block) + size;
+		m_reserved += size;
+		m_nextBlockSize = std::min(m_nextBlockSize * 2, std::max(maxArenaBlockSize, m_blockSize));
+
+		ptr = alignUp(m_cur);
+	}
+
+	m_cur = ptr + n;
+	m_used += n;
+	return ptr;
+}
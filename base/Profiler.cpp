@@ -0,0 +1,226 @@
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+#include "pthread.h"
+
+#include "gpwe/util/Profiler.hpp"
+#include "gpwe/util/SpscRing.hpp"
+#include "gpwe/util/List.hpp"
+#include "gpwe/log.hpp"
+
+using namespace gpwe;
+
+namespace {
+	using ProfClock = std::chrono::steady_clock;
+
+	constexpr std::size_t threadRingSize = 16 * 1024;
+
+	struct ThreadRing{
+		SpscRing<prof::Zone> zones{ threadRingSize };
+		Nat32 id;
+		std::atomic_bool alive = true;
+	};
+
+	struct State{
+		const ProfClock::time_point epoch = ProfClock::now();
+
+		std::mutex mut;
+		Vector<ThreadRing*> rings;
+		Vector<Str> threadNames; // by thread id, kept after the thread exits
+		List<prof::Frame> frames;
+		std::size_t maxFrames = 300;
+		Nat64 frameIndex = 0;
+
+		std::atomic<Nat64> numDropped = 0;
+	};
+
+	// never destroyed, threads may still be exiting during static destruction
+	State &state(){
+		static auto ret = new State;
+		return *ret;
+	}
+
+	struct ThreadZones{
+		~ThreadZones(){
+			if(ring) ring->alive.store(false, std::memory_order_release);
+		}
+
+		ThreadRing *ring = nullptr;
+		Nat32 depth = 0;
+	};
+
+	thread_local ThreadZones t_zones;
+
+	ThreadRing *registerThread(){
+		auto &&s = state();
+		auto ring = new ThreadRing;
+
+		char name[16] = "";
+		pthread_getname_np(pthread_self(), name, sizeof(name));
+
+		std::lock_guard lock(s.mut);
+		ring->id = Nat32(s.threadNames.size());
+		s.threadNames.emplace_back(name);
+		s.rings.emplace_back(ring);
+		return ring;
+	}
+
+	void placeZone(State &s, const prof::Zone &zone){
+		// newest first, most zones belong to the frame that just ended
+		for(auto it = s.frames.end(); it != s.frames.begin();){
+			--it;
+
+			if(it->start <= zone.start){
+				it->zones.emplace_back(zone);
+				return;
+			}
+		}
+	}
+
+	void escapeJson(Str &out, StrView str){
+		for(auto c : str){
+			switch(c){
+				case '"': out += "\\\""; break;
+				case '\\': out += "\\\\"; break;
+				case '\n': out += "\\n"; break;
+				default:
+					if(Nat8(c) < 0x20) formatTo<"\\u{:04x}">(out, unsigned(c));
+					else out += c;
+					break;
+			}
+		}
+	}
+}
+
+Nat64 prof::now() noexcept{
+	return Nat64(std::chrono::duration_cast<std::chrono::nanoseconds>(ProfClock::now() - state().epoch).count());
+}
+
+Nat32 prof::enterZone() noexcept{
+	return t_zones.depth++;
+}
+
+void prof::leaveZone(const char *name, Nat64 start, Nat32 depth) noexcept{
+	const auto end = now();
+
+	t_zones.depth = depth;
+
+	if(!t_zones.ring){
+		t_zones.ring = registerThread();
+	}
+
+	if(!t_zones.ring->zones.tryPush(Zone{ name, start, end, t_zones.ring->id, depth })){
+		state().numDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void prof::frameMark(){
+	auto &&s = state();
+	const auto time = now();
+
+	std::lock_guard lock(s.mut);
+
+	if(!s.frames.empty()){
+		s.frames.back().end = time;
+	}
+
+	for(auto ring : s.rings){
+		ring->zones.drain([&s](const Zone &zone){ placeZone(s, zone); });
+	}
+
+	std::erase_if(s.rings, [](auto ring){
+		if(ring->alive.load(std::memory_order_acquire) || !ring->zones.empty()) return false;
+		delete ring;
+		return true;
+	});
+
+	s.frames.emplace_back(Frame{ s.frameIndex++, time, 0, {} });
+
+	while(s.frames.size() > s.maxFrames){
+		s.frames.pop_front();
+	}
+}
+
+void prof::setMaxFrames(std::size_t n){
+	auto &&s = state();
+	std::lock_guard lock(s.mut);
+
+	s.maxFrames = std::max<std::size_t>(n, 1);
+
+	while(s.frames.size() > s.maxFrames){
+		s.frames.pop_front();
+	}
+}
+
+std::size_t prof::maxFrames() noexcept{
+	return state().maxFrames;
+}
+
+Vector<prof::Frame> prof::frames(){
+	auto &&s = state();
+	std::lock_guard lock(s.mut);
+	return Vector<Frame>(s.frames.begin(), s.frames.end());
+}
+
+Nat64 prof::numDropped() noexcept{
+	return state().numDropped.load(std::memory_order_relaxed);
+}
+
+Str prof::chromeTrace(){
+	auto &&s = state();
+	std::lock_guard lock(s.mut);
+
+	Str out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+
+	auto sep = [&]{
+		if(!first) out += ",\n";
+		first = false;
+	};
+
+	for(std::size_t i = 0; i < s.threadNames.size(); i++){
+		sep();
+		out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,";
+		formatTo<"\"tid\":{},\"args\":{{\"name\":\"">(out, i);
+		escapeJson(out, s.threadNames[i].empty() ? StrView("thread") : StrView(s.threadNames[i]));
+		out += "\"}}";
+	}
+
+	// trace timestamps are microseconds
+	for(auto &&frame : s.frames){
+		sep();
+		formatTo<"{{\"name\":\"frame {}\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":{:.3f}}}">(out, frame.index, frame.start / 1000.0);
+
+		for(auto &&zone : frame.zones){
+			sep();
+			out += "{\"name\":\"";
+			escapeJson(out, zone.name);
+			formatTo<"\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}">(
+				out, zone.thread, zone.start / 1000.0, (zone.end - zone.start) / 1000.0
+			);
+		}
+	}
+
+	out += "]}\n";
+	return out;
+}
+
+bool prof::writeChromeTrace(StrView path){
+	const auto trace = chromeTrace();
+
+	auto file = std::fopen(Str(path).c_str(), "wb");
+	if(!file){
+		log::errorLn("Could not open '{}' to write the profile trace", path);
+		return false;
+	}
+
+	const bool ok = std::fwrite(trace.data(), 1, trace.size(), file) == trace.size();
+	std::fclose(file);
+
+	if(!ok){
+		log::errorLn("Could not write the profile trace to '{}'", path);
+	}
+
+	return ok;
+}
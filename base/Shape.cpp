@@ -176,10 +176,10 @@ shapes::TriangleMesh HeightMapShape::generateMesh(float scale, float maxHeight)
 	const float dimX = m_w * scale;
 	const float dimY = m_h * scale * aspect;
 
-	Nat32 numPoints = m_w * m_h;
-	Nat32 numIndices = ((m_w-1) * (m_h-1)) * 2 * 3;
+	Nat32 numPoints = Nat32(m_w) * m_h;
+	Nat32 numIndices = (Nat32(m_w - 1) * Nat32(m_h - 1)) * 2 * 3;
 	Vector<Vec3> verts;
-	Vector<Vec4> norms;
+	Vector<Vec4> norms; // 256MiB at 4096x4096, too big to leave in the frame arena
 	Vector<glm::vec2> uvs;
 	Vector<Nat32> indices;
 
@@ -193,11 +193,12 @@ shapes::TriangleMesh HeightMapShape::generateMesh(float scale, float maxHeight)
 
 	const float xyOff = scale * -0.5f;
 
-	for(Nat16 y = 0; y < m_h; y++){
-		const Nat16 yIdx = y * m_w;
+	// 32-bit indices, anything past 256x256 overflows 16 bits
+	for(Nat32 y = 0; y < m_h; y++){
+		const Nat32 yIdx = y * m_w;
 		const float yRel = y * yStep;
-		for(Nat16 x = 0; x < m_w; x++){
-			const Nat16 idx = yIdx + x;
+		for(Nat32 x = 0; x < m_w; x++){
+			const Nat32 idx = yIdx + x;
 			const float xRel = x * xStep;
 
 			verts.emplace_back(xyOff + (xRel * scale), m_values[idx] * maxHeight, xyOff + (yRel * scale));
@@ -208,10 +209,10 @@ shapes::TriangleMesh HeightMapShape::generateMesh(float scale, float maxHeight)
 
 	Nat32 y0Idx = 0;
 
-	for(Nat16 y = 1; y < m_h; y++){
+	for(Nat32 y = 1; y < m_h; y++){
 		const Nat32 y1Idx = y * m_w;
 
-		for(Nat16 x = 0; x < (m_w - 1); x++){
+		for(Nat32 x = 0; x + 1 < m_w; x++){
 			Nat32 i0 = y0Idx + x;
 			Nat32 i1 = y0Idx + x + 1;
 			Nat32 i2 = y1Idx + x + 1;
@@ -0,0 +1,270 @@
+#include <algorithm>
+
+#include "gpwe/util/TimerWheel.hpp"
+#include "gpwe/util/JobSystem.hpp"
+
+using namespace gpwe;
+
+TimerWheel::TimerWheel(Duration resolution_)
+	: m_resolution(std::max(resolution_, Duration(1)))
+{
+	for(auto &&level : m_slots){
+		std::fill(std::begin(level), std::end(level), nil);
+	}
+}
+
+Nat64 TimerWheel::toTicks(Duration d) const noexcept{
+	// round up, a timer never fires early
+	return Nat64((std::max(d, Duration::zero()).count() + m_resolution.count() - 1) / m_resolution.count());
+}
+
+TimerWheel::Handle TimerWheel::after(Duration delay, Fn<void()> fn, TimerDispatch dispatch){
+	std::lock_guard lock(m_mut);
+	return schedule(toTicks(delay), 0, std::move(fn), dispatch);
+}
+
+TimerWheel::Handle TimerWheel::every(Duration period, Fn<void()> fn, TimerDispatch dispatch){
+	std::lock_guard lock(m_mut);
+	const auto ticks = std::max<Nat64>(toTicks(period), 1);
+	return schedule(ticks, ticks, std::move(fn), dispatch);
+}
+
+TimerWheel::Handle TimerWheel::schedule(Nat64 delayTicks, Nat64 period, Fn<void()> fn, TimerDispatch dispatch){
+	Nat32 idx;
+
+	if(m_freeHead != nil){
+		idx = m_freeHead;
+		m_freeHead = m_nodes[idx].next;
+	}
+	else{
+		idx = Nat32(m_nodes.size());
+		m_nodes.emplace_back(Node{ nullptr, 0, 0, 1, nil, nil, 0, State::free, TimerDispatch::caller });
+	}
+
+	auto &&node = m_nodes[idx];
+	node.fn = std::move(fn);
+	node.expiry = m_now + std::max<Nat64>(delayTicks, 1);
+	node.period = period;
+	node.state = State::scheduled;
+	node.dispatch = dispatch;
+
+	link(idx);
+	++m_numPending;
+
+	return Handle(idx, node.gen);
+}
+
+TimerWheel::Node *TimerWheel::lookup(Handle handle) noexcept{
+	if(!handle || handle.m_idx >= m_nodes.size()) return nullptr;
+
+	auto &&node = m_nodes[handle.m_idx];
+	if(node.gen != handle.m_gen || node.state == State::free) return nullptr;
+
+	return &node;
+}
+
+const TimerWheel::Node *TimerWheel::lookup(Handle handle) const noexcept{
+	return const_cast<TimerWheel*>(this)->lookup(handle);
+}
+
+bool TimerWheel::cancel(Handle handle){
+	Fn<void()> fn;
+
+	{
+		std::lock_guard lock(m_mut);
+
+		auto node = lookup(handle);
+		if(!node) return false;
+
+		switch(node->state){
+			case State::scheduled:{
+				unlink(handle.m_idx);
+				fn = std::move(node->fn);
+				release(handle.m_idx);
+				--m_numPending;
+				break;
+			}
+
+			case State::running:{
+				// advance owns the callback right now, it frees the node when done
+				node->state = State::cancelled;
+				--m_numPending;
+				break;
+			}
+
+			default: return false;
+		}
+	}
+
+	// captures are destroyed outside the lock, they might cancel timers too
+	return true;
+}
+
+bool TimerWheel::pending(Handle handle) const{
+	std::lock_guard lock(m_mut);
+	auto node = lookup(handle);
+	return node && (node->state == State::scheduled || node->state == State::running);
+}
+
+std::size_t TimerWheel::numPending() const{
+	std::lock_guard lock(m_mut);
+	return m_numPending;
+}
+
+void TimerWheel::link(Nat32 idx){
+	auto &&node = m_nodes[idx];
+
+	const auto delta = std::min<Nat64>(node.expiry - m_now, (Nat64(1) << (levelBits * numLevels)) - 1);
+
+	Nat32 level = 0;
+	while(level < (numLevels - 1) && delta >= (Nat64(1) << (levelBits * (level + 1)))){
+		++level;
+	}
+
+	// far future timers park in the top level and get re-linked when it cascades
+	const auto at = std::min(node.expiry, m_now + delta);
+	const auto slot = Nat32((at >> (levelBits * level)) & slotMask);
+
+	auto &&head = m_slots[level][slot];
+
+	node.slot = Nat16((level << levelBits) | slot);
+	node.prev = nil;
+	node.next = head;
+
+	if(head != nil) m_nodes[head].prev = idx;
+	head = idx;
+}
+
+void TimerWheel::unlink(Nat32 idx) noexcept{
+	auto &&node = m_nodes[idx];
+
+	if(node.prev != nil){
+		m_nodes[node.prev].next = node.next;
+	}
+	else{
+		m_slots[node.slot >> levelBits][node.slot & slotMask] = node.next;
+	}
+
+	if(node.next != nil){
+		m_nodes[node.next].prev = node.prev;
+	}
+
+	node.prev = node.next = nil;
+}
+
+void TimerWheel::release(Nat32 idx) noexcept{
+	auto &&node = m_nodes[idx];
+	node.fn = nullptr;
+	node.state = State::free;
+
+	// skip 0 so a default handle never matches
+	if(++node.gen == 0) node.gen = 1;
+
+	node.next = m_freeHead;
+	m_freeHead = idx;
+}
+
+void TimerWheel::cascade(Nat32 level){
+	const auto slot = Nat32((m_now >> (levelBits * level)) & slotMask);
+
+	auto idx = std::exchange(m_slots[level][slot], nil);
+
+	while(idx != nil){
+		const auto next = m_nodes[idx].next;
+		link(idx);
+		idx = next;
+	}
+}
+
+void TimerWheel::collect(Vector<Due> &due){
+	++m_now;
+
+	// higher levels roll over when every level below them wraps, cascade from the top
+	for(Nat32 level = numLevels - 1; level > 0; level--){
+		const auto lowMask = (Nat64(1) << (levelBits * level)) - 1;
+		if((m_now & lowMask) == 0){
+			cascade(level);
+		}
+	}
+
+	auto idx = std::exchange(m_slots[0][m_now & slotMask], nil);
+
+	while(idx != nil){
+		auto &&node = m_nodes[idx];
+		const auto next = node.next;
+
+		node.prev = node.next = nil;
+		node.state = State::running;
+		due.emplace_back(Due{ idx, node.dispatch, std::move(node.fn) });
+
+		idx = next;
+	}
+}
+
+void TimerWheel::advance(Duration elapsed){
+	Vector<Due> due;
+
+	{
+		std::lock_guard lock(m_mut);
+
+		m_accum += elapsed;
+
+		const auto ticks = Nat64(m_accum / m_resolution);
+		m_accum -= m_resolution * ticks;
+
+		if(!ticks) return;
+
+		// reuse the last advance's buffer, unless a callback is advancing too
+		due.swap(m_due);
+
+		for(Nat64 i = 0; i < ticks; i++){
+			collect(due);
+		}
+	}
+
+	if(due.empty()) return;
+
+	JobCounter counter;
+
+	for(auto &&d : due){
+		if(m_jobs && d.dispatch == TimerDispatch::jobs){
+			m_jobs->run([&d]{ d.fn(); }, counter);
+		}
+		else{
+			d.fn();
+		}
+	}
+
+	if(m_jobs) m_jobs->wait(counter);
+
+	{
+		std::lock_guard lock(m_mut);
+
+		for(auto &&d : due){
+			auto &&node = m_nodes[d.idx];
+
+			if(node.state == State::running && node.period){
+				node.fn = std::move(d.fn);
+				node.state = State::scheduled;
+
+				// skip missed periods rather than firing them all at once
+				node.expiry += node.period;
+				if(node.expiry <= m_now){
+					node.expiry = m_now + node.period - ((m_now - node.expiry) % node.period);
+				}
+
+				link(d.idx);
+			}
+			else{
+				if(node.state == State::running) --m_numPending;
+				release(d.idx);
+			}
+		}
+	}
+
+	// one-shot captures die outside the lock, their destructors may use the wheel
+	due.clear();
+
+	std::lock_guard lock(m_mut);
+	if(m_due.capacity() < due.capacity()) m_due.swap(due);
+}
@@ -1,3 +1,287 @@
+#include <cstring>
+
+#include "gpwe/log.hpp"
 #include "gpwe/input.hpp"
 
 using namespace gpwe;
+
+namespace {
+	// recording layout: header, then per frame a FrameHeader followed by its events
+	constexpr char recordMagic[8] = { 'G', 'P', 'W', 'E', 'I', 'N', 'P', 'T' };
+	constexpr Nat32 recordVersion = 1;
+
+	struct RecordHeader{
+		char magic[8];
+		Nat32 version;
+		Nat32 eventSize;
+	};
+
+	struct FrameHeader{
+		Nat64 frame;
+		float dt;
+		Nat32 numEvents;
+	};
+}
+
+input::Manager::Manager()
+	: m_start(std::chrono::steady_clock::now())
+	, m_events(4096)
+{
+	m_frameEvents.reserve(256);
+}
+
+input::Manager::~Manager(){
+	stopRecording();
+	stopReplay();
+}
+
+bool input::Manager::pushEvent(RawEvent ev) noexcept{
+	ev.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+
+	if(!m_events.tryPush(ev)){
+		m_numDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+void input::Manager::update(float dt){
+	for(auto &&fn : m_pumpFns){
+		fn();
+	}
+
+	pumpEvents();
+
+	const auto latest = m_latest.load(std::memory_order_relaxed);
+	const auto &prev = m_snapshots[latest];
+	const auto next = Nat32((latest + 1) % numSnapshots);
+	auto &&snap = m_snapshots[next];
+
+	snap = Snapshot{};
+	snap.frame = prev.frame + 1;
+	snap.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+	snap.keys = prev.keys;
+	snap.buttons = prev.buttons;
+
+	m_frameEvents.clear();
+
+	m_events.drain([this](const RawEvent &ev){
+		// while replaying live input only gets a say in quitting
+		if(m_replayFile && ev.kind != EventKind::exit) return;
+		m_frameEvents.emplace_back(ev);
+	});
+
+	if(const auto numDropped = m_numDropped.load(std::memory_order_relaxed); numDropped != m_numDroppedSeen){
+		log::warnLn("Input event ring full, dropped {} events", numDropped - m_numDroppedSeen);
+		m_numDroppedSeen = numDropped;
+	}
+
+	if(m_replayFile && !readReplayFrame()){
+		log::infoLn("Input replay finished after {} frames", snap.frame);
+		stopReplay();
+	}
+
+	for(auto &&ev : m_frameEvents){
+		switch(ev.kind){
+			case EventKind::key:{
+				if(ev.code >= (Nat16)Key::count) continue;
+
+				snap.keys[ev.code] = ev.x;
+				(ev.x ? snap.keysPressed : snap.keysReleased)[ev.code] = true;
+				break;
+			}
+
+			case EventKind::mouseButton:{
+				if(ev.code >= (Nat16)MouseButton::count) continue;
+
+				snap.buttons[ev.code] = ev.x;
+				(ev.x ? snap.buttonsPressed : snap.buttonsReleased)[ev.code] = true;
+				break;
+			}
+
+			case EventKind::mouseMove:{
+				snap.mouseDx += ev.x;
+				snap.mouseDy += ev.y;
+				break;
+			}
+
+			case EventKind::mouseScroll:{
+				snap.scrollX += ev.x;
+				snap.scrollY += ev.y;
+				break;
+			}
+
+			default: break;
+		}
+
+		++snap.numEvents;
+	}
+
+	if(m_recordFile){
+		writeRecordFrame(snap.frame, dt);
+	}
+
+	// publish before dispatching so callbacks see this frame's state
+	m_latest.store(next, std::memory_order_release);
+
+	for(auto &&ev : m_frameEvents){
+		dispatch(ev);
+	}
+
+	for(auto &&kb : managed<Keyboard>()){
+		kb->keyEvent().flush();
+	}
+
+	for(auto &&mouse : managed<Mouse>()){
+		mouse->buttonEvent().flush();
+		mouse->moveEvent().flush();
+		mouse->scrollEvent().flush();
+	}
+
+	m_sys.m_exitEvent.flush();
+}
+
+void input::Manager::dispatch(const RawEvent &ev){
+	switch(ev.kind){
+		case EventKind::key:{
+			if(ev.code >= (Nat16)Key::count) break;
+
+			for(auto &&kb : managed<Keyboard>()){
+				kb->keyEvent().emit(Key(ev.code), ev.x != 0);
+			}
+
+			break;
+		}
+
+		case EventKind::mouseButton:{
+			if(ev.code >= (Nat16)MouseButton::count) break;
+
+			for(auto &&mouse : managed<Mouse>()){
+				mouse->buttonEvent().emit(MouseButton(ev.code), ev.x != 0);
+			}
+
+			break;
+		}
+
+		case EventKind::mouseMove:{
+			for(auto &&mouse : managed<Mouse>()){
+				mouse->moveEvent().emit(ev.x, ev.y);
+			}
+
+			break;
+		}
+
+		case EventKind::mouseScroll:{
+			for(auto &&mouse : managed<Mouse>()){
+				mouse->scrollEvent().emit(ev.x, ev.y);
+			}
+
+			break;
+		}
+
+		case EventKind::exit:{
+			m_sys.exitEvent();
+			break;
+		}
+
+		default: break;
+	}
+}
+
+bool input::Manager::startRecording(StrView path){
+	stopRecording();
+
+	const Str pathStr(path);
+
+	m_recordFile = std::fopen(pathStr.c_str(), "wb");
+	if(!m_recordFile){
+		log::errorLn("Could not open '{}' for recording input", path);
+		return false;
+	}
+
+	RecordHeader header;
+	std::memcpy(header.magic, recordMagic, sizeof(recordMagic));
+	header.version = recordVersion;
+	header.eventSize = sizeof(RawEvent);
+
+	if(std::fwrite(&header, sizeof(header), 1, m_recordFile) != 1){
+		log::errorLn("Could not write input recording header to '{}'", path);
+		stopRecording();
+		return false;
+	}
+
+	return true;
+}
+
+void input::Manager::stopRecording(){
+	if(!m_recordFile) return;
+
+	std::fclose(m_recordFile);
+	m_recordFile = nullptr;
+}
+
+void input::Manager::writeRecordFrame(Nat64 frame, float dt){
+	const FrameHeader header{ frame, dt, Nat32(m_frameEvents.size()) };
+
+	const bool ok =
+		std::fwrite(&header, sizeof(header), 1, m_recordFile) == 1 &&
+		(m_frameEvents.empty() || std::fwrite(m_frameEvents.data(), sizeof(RawEvent), m_frameEvents.size(), m_recordFile) == m_frameEvents.size());
+
+	if(!ok){
+		log::errorLn("Failed writing input recording, stopping");
+		stopRecording();
+	}
+}
+
+bool input::Manager::startReplay(StrView path){
+	stopReplay();
+
+	const Str pathStr(path);
+
+	m_replayFile = std::fopen(pathStr.c_str(), "rb");
+	if(!m_replayFile){
+		log::errorLn("Could not open input recording '{}'", path);
+		return false;
+	}
+
+	RecordHeader header;
+
+	if(
+		std::fread(&header, sizeof(header), 1, m_replayFile) != 1 ||
+		std::memcmp(header.magic, recordMagic, sizeof(recordMagic)) != 0 ||
+		header.version != recordVersion ||
+		header.eventSize != sizeof(RawEvent)
+	){
+		log::errorLn("'{}' is not a compatible input recording", path);
+		stopReplay();
+		return false;
+	}
+
+	return true;
+}
+
+void input::Manager::stopReplay(){
+	if(!m_replayFile) return;
+
+	std::fclose(m_replayFile);
+	m_replayFile = nullptr;
+}
+
+bool input::Manager::readReplayFrame(){
+	FrameHeader header;
+	if(std::fread(&header, sizeof(header), 1, m_replayFile) != 1){
+		return false;
+	}
+
+	const auto offset = m_frameEvents.size();
+	m_frameEvents.resize(offset + header.numEvents);
+
+	if(header.numEvents && std::fread(m_frameEvents.data() + offset, sizeof(RawEvent), header.numEvents, m_replayFile) != header.numEvents){
+		m_frameEvents.resize(offset);
+		return false;
+	}
+
+	m_replayDt = header.dt;
+	return true;
+}
@@ -0,0 +1,1557 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "pthread.h"
+
+#include "gpwe/util/Allocator.hpp"
+#include "gpwe/util/Pool.hpp"
+#include "gpwe/util/types.hpp"
+#include "gpwe/memory.hpp"
+
+using namespace gpwe;
+
+/*
+ * General purpose allocator behind sys::alloc/sys::free
+ *
+ * Memory is handed out in spans of spanSize bytes, each aligned to spanSize.
+ * The first spanHeaderSize bytes of every span hold a SpanHeader, so the owner
+ * of any pointer is found by masking off the low bits; no lookup table needed.
+ *
+ * Small allocations are rounded up to one of numSizeClasses size classes and
+ * served from a per-thread cache of free lists. Caches refill from and spill
+ * back to a central free list per size class in batches, which is the only
+ * place a lock is taken. The central lists keep free objects with their span,
+ * so spans that empty out past maxEmptySmallSpans go back to the page
+ * allocator like medium ones. Anything bigger than maxSmallSize is carved out of a
+ * span as a run of runSize units if it fits, or gets its own mapping straight
+ * from the page allocator. Free spans past maxRetainedSpans are handed back
+ * to the OS, their address range is kept for reuse.
+ */
+
+namespace {
+	constexpr std::size_t spanSize = 256 * 1024;
+	constexpr std::uintptr_t spanMask = ~std::uintptr_t(spanSize - 1);
+	constexpr std::size_t spanHeaderSize = 64;
+	constexpr std::size_t spansPerChunk = 16;
+
+	constexpr std::size_t numSizeClasses = 40;
+	constexpr std::size_t maxSmallSize = 32 * 1024;
+
+	// medium allocations take runs of these, one bit each in a span's bitmaps
+	constexpr std::size_t runSize = spanSize / 64;
+	constexpr std::size_t maxRunAllocSize = spanSize - spanHeaderSize;
+
+	// free spans kept resident, any more have their pages released
+	constexpr std::size_t maxRetainedSpans = spansPerChunk;
+
+	// wholly free small spans a central list holds on to before handing them back
+	constexpr std::size_t maxEmptySmallSpans = 1;
+
+	// 16 byte steps up to 128, then 4 steps per power of two up to maxSmallSize
+	constexpr std::size_t sizeClassIndex(std::size_t n) noexcept{
+		if(n <= 128){
+			return n == 0 ? 0 : (n - 1) >> 4;
+		}
+
+		const std::size_t k = (sizeof(unsigned long long) * 8 - 1) - __builtin_clzll(n - 1);
+		return 8 + ((k - 7) * 4) + (((n - 1) - (std::size_t(1) << k)) >> (k - 2));
+	}
+
+	constexpr std::size_t sizeClassSize(std::size_t idx) noexcept{
+		if(idx < 8){
+			return (idx + 1) << 4;
+		}
+
+		const std::size_t j = idx - 8;
+		const std::size_t k = 7 + (j / 4);
+		return (std::size_t(1) << k) + (((j % 4) + 1) << (k - 2));
+	}
+
+	static_assert(sizeClassIndex(1) == 0 && sizeClassIndex(16) == 0 && sizeClassIndex(17) == 1);
+	static_assert(sizeClassIndex(129) == 8 && sizeClassSize(8) == 160);
+	static_assert(sizeClassIndex(256) == 11 && sizeClassSize(11) == 256);
+	static_assert(sizeClassIndex(maxSmallSize) == numSizeClasses - 1);
+	static_assert(sizeClassSize(numSizeClasses - 1) == maxSmallSize);
+
+	// number of objects moved between a thread cache and the central lists at once
+	constexpr Nat32 sizeClassBatch(std::size_t idx) noexcept{
+		const std::size_t n = (64 * 1024) / sizeClassSize(idx);
+		return Nat32(std::clamp<std::size_t>(n, 2, 64));
+	}
+
+	constexpr Nat32 sizeClassObjCount(std::size_t idx) noexcept{
+		return Nat32((spanSize - spanHeaderSize) / sizeClassSize(idx));
+	}
+
+	static_assert(sizeClassObjCount(0) <= 0xffff, "small span object counts must fit a Nat16");
+
+	template<typename Fn, std::size_t ... Indices>
+	constexpr auto makeSizeClassTable(Fn fn, std::index_sequence<Indices...>) noexcept{
+		return std::array{ fn(Indices)... };
+	}
+
+	// keep divisions and bit twiddling out of the fast paths
+	constexpr auto sizeClassSizes = makeSizeClassTable(sizeClassSize, std::make_index_sequence<numSizeClasses>{});
+	constexpr auto sizeClassBatches = makeSizeClassTable(sizeClassBatch, std::make_index_sequence<numSizeClasses>{});
+	constexpr auto sizeClassObjCounts = makeSizeClassTable(sizeClassObjCount, std::make_index_sequence<numSizeClasses>{});
+
+	enum class SpanKind: Nat8{
+		small, // carved into objects of one size class
+		runs, // carved into runs of runSize units, one allocation each
+		large, // a single allocation with its own mapping
+		tlsf, // a region of a real-time heap
+		pool, // a chunk of a PoolBase
+		count
+	};
+
+	struct alignas(spanHeaderSize) SpanHeader{
+		SpanKind kind;
+		Nat8 tag; // pool only, the ManagerKind its blocks are counted against
+		Nat16 numFree; // small only, objects on freeObjs
+		Nat32 sizeClass;
+		std::size_t len;
+		SpanHeader *next, *prev;
+		void *owner;
+
+		// runs only, units in use and the first unit of each run
+		Nat64 usedRuns, runStarts;
+
+		// small only, this span's objects sitting in the central list
+		void *freeObjs;
+	};
+
+	// Doubly linked span list, so spans leave from anywhere in O(1)
+	struct SpanList{
+		SpanHeader *first = nullptr, *last = nullptr;
+
+		void pushFront(SpanHeader *span) noexcept{
+			span->prev = nullptr;
+			span->next = first;
+			if(first) first->prev = span;
+			else last = span;
+			first = span;
+		}
+
+		void pushBack(SpanHeader *span) noexcept{
+			span->next = nullptr;
+			span->prev = last;
+			if(last) last->next = span;
+			else first = span;
+			last = span;
+		}
+
+		void remove(SpanHeader *span) noexcept{
+			if(span->prev) span->prev->next = span->next;
+			else first = span->next;
+
+			if(span->next) span->next->prev = span->prev;
+			else last = span->prev;
+
+			span->next = span->prev = nullptr;
+		}
+	};
+
+	static_assert(sizeof(SpanHeader) == spanHeaderSize);
+
+	inline SpanHeader *spanOf(void *ptr) noexcept{
+		return reinterpret_cast<SpanHeader*>(reinterpret_cast<std::uintptr_t>(ptr) & spanMask);
+	}
+
+	[[noreturn]] void outOfMemory(const char *what, std::size_t len){
+		// can't use the logger here, it allocates
+		std::fprintf(stderr, "Error in %s(%zu): %s\n", what, len, std::strerror(errno));
+		std::abort();
+	}
+
+	class PageAllocator{
+		public:
+			constexpr PageAllocator() noexcept = default;
+
+			static std::size_t pageSize() noexcept{
+				static const std::size_t ret = sysconf(_SC_PAGESIZE);
+				return ret;
+			}
+
+			// Get a single span aligned to spanSize
+			SpanHeader *allocSpan(){
+				std::lock_guard lock(m_mut);
+
+				if(m_freeSpans){
+					auto ret = m_freeSpans;
+					m_freeSpans = ret->next;
+					--m_numFree;
+					return ret;
+				}
+
+				// released pages fault back in zeroed on first touch
+				if(m_releasedSpans){
+					auto ret = m_releasedSpans;
+					m_releasedSpans = ret->next;
+					return ret;
+				}
+
+				if(m_chunkCur == m_chunkEnd){
+					m_chunkCur = reinterpret_cast<char*>(mapAligned(spanSize * spansPerChunk));
+					m_chunkEnd = m_chunkCur + (spanSize * spansPerChunk);
+				}
+
+				auto ret = reinterpret_cast<SpanHeader*>(m_chunkCur);
+				m_chunkCur += spanSize;
+				return ret;
+			}
+
+			void freeSpan(SpanHeader *span) noexcept{
+				{
+					std::lock_guard lock(m_mut);
+
+					if(m_numFree < maxRetainedSpans){
+						span->next = m_freeSpans;
+						m_freeSpans = span;
+						++m_numFree;
+						return;
+					}
+				}
+
+				// keep the address range, so spans stay aligned and chunks never split
+				if(madvise(span, spanSize, MADV_DONTNEED) != 0){
+					std::fprintf(stderr, "Error in madvise: %s\n", std::strerror(errno));
+				}
+
+				std::lock_guard lock(m_mut);
+				span->next = m_releasedSpans;
+				m_releasedSpans = span;
+			}
+
+			// Map len bytes (rounded up to pages) aligned to spanSize
+			static void *mapAligned(std::size_t len){
+				const auto mapLen = len + spanSize;
+
+				auto mem = mmap(
+					nullptr, mapLen,
+					PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS,
+					-1, 0
+				);
+
+				if(mem == MAP_FAILED){
+					outOfMemory("mmap", mapLen);
+				}
+
+				const auto memAddr = reinterpret_cast<std::uintptr_t>(mem);
+				const auto alignedAddr = (memAddr + spanSize - 1) & spanMask;
+				const auto headLen = alignedAddr - memAddr;
+				const auto tailLen = mapLen - headLen - len;
+
+				if(headLen) munmap(mem, headLen);
+				if(tailLen) munmap(reinterpret_cast<void*>(alignedAddr + len), tailLen);
+
+				return reinterpret_cast<void*>(alignedAddr);
+			}
+
+			static void unmap(void *ptr, std::size_t len) noexcept{
+				if(munmap(ptr, len) != 0){
+					std::fprintf(stderr, "Error in munmap: %s\n", std::strerror(errno));
+				}
+			}
+
+		private:
+			std::mutex m_mut;
+			SpanHeader *m_freeSpans = nullptr, *m_releasedSpans = nullptr;
+			std::size_t m_numFree = 0;
+			char *m_chunkCur = nullptr, *m_chunkEnd = nullptr;
+	};
+
+	constinit PageAllocator pageAllocator;
+
+	/*
+	 * Free objects stay threaded through their own span, and spans with any
+	 * free are kept on a list. Batches are taken from the front span first,
+	 * spans that empty out completely go to the back, or back to the page
+	 * allocator once more than maxEmptySmallSpans are held.
+	 */
+	class CentralFreeList{
+		public:
+			constexpr CentralFreeList() noexcept = default;
+
+			// Pop up to n objects, returned as a singly linked chain
+			Nat32 remove(std::size_t cls, Nat32 n, void **head){
+				std::lock_guard lock(m_mut);
+
+				if(!m_spans.first){
+					populate(cls);
+				}
+
+				const auto numObjs = sizeClassObjCounts[cls];
+
+				void *first = nullptr;
+				Nat32 ret = 0;
+
+				while(ret < n && m_spans.first){
+					auto span = m_spans.first;
+
+					if(span->numFree == numObjs){
+						--m_numEmpty;
+					}
+
+					for(; ret < n && span->numFree; ret++){
+						auto obj = span->freeObjs;
+						span->freeObjs = *reinterpret_cast<void**>(obj);
+						*reinterpret_cast<void**>(obj) = first;
+						first = obj;
+						--span->numFree;
+					}
+
+					if(!span->numFree){
+						m_spans.remove(span);
+					}
+				}
+
+				*head = first;
+				return ret;
+			}
+
+			// Push n objects from a chain starting at head, the chain may run on past them
+			void insert(std::size_t cls, void *head, Nat32 n) noexcept{
+				const auto numObjs = sizeClassObjCounts[cls];
+				SpanHeader *released = nullptr;
+
+				{
+					std::lock_guard lock(m_mut);
+
+					for(Nat32 i = 0; i < n; i++){
+						auto obj = head;
+						head = *reinterpret_cast<void**>(obj);
+
+						auto span = spanOf(obj);
+						*reinterpret_cast<void**>(obj) = span->freeObjs;
+						span->freeObjs = obj;
+
+						if(span->numFree++ == 0){
+							m_spans.pushFront(span);
+						}
+
+						if(span->numFree != numObjs){
+							continue;
+						}
+
+						m_spans.remove(span);
+
+						if(m_numEmpty < maxEmptySmallSpans){
+							m_spans.pushBack(span);
+							++m_numEmpty;
+						}
+						else{
+							span->next = released;
+							released = span;
+						}
+					}
+				}
+
+				// may madvise, keep it out from under the lock
+				while(released){
+					auto next = released->next;
+					pageAllocator.freeSpan(released);
+					released = next;
+				}
+			}
+
+		private:
+			void populate(std::size_t cls){
+				const auto objSize = sizeClassSizes[cls];
+				const auto numObjs = sizeClassObjCounts[cls];
+
+				auto span = pageAllocator.allocSpan();
+				span->kind = SpanKind::small;
+				span->numFree = Nat16(numObjs);
+				span->sizeClass = Nat32(cls);
+				span->len = spanSize;
+				span->owner = nullptr;
+				span->freeObjs = nullptr;
+
+				auto beg = reinterpret_cast<char*>(span) + spanHeaderSize;
+
+				for(Nat32 i = numObjs; i > 0; i--){
+					auto obj = beg + ((i - 1) * objSize);
+					*reinterpret_cast<void**>(obj) = span->freeObjs;
+					span->freeObjs = obj;
+				}
+
+				m_spans.pushFront(span);
+				++m_numEmpty;
+			}
+
+			std::mutex m_mut;
+			SpanList m_spans;
+			std::size_t m_numEmpty = 0;
+	};
+
+	constinit CentralFreeList centralLists[numSizeClasses];
+
+	class ThreadCache{
+		public:
+			void *alloc(std::size_t cls){
+				auto &&bin = m_bins[cls];
+
+				if(!bin.head){
+					bin.count = centralLists[cls].remove(cls, sizeClassBatches[cls], &bin.head);
+				}
+
+				auto ret = bin.head;
+				bin.head = *reinterpret_cast<void**>(ret);
+				--bin.count;
+				return ret;
+			}
+
+			void free(std::size_t cls, void *ptr) noexcept{
+				auto &&bin = m_bins[cls];
+
+				*reinterpret_cast<void**>(ptr) = bin.head;
+				bin.head = ptr;
+
+				const auto batch = sizeClassBatches[cls];
+				if(++bin.count >= batch * 2){
+					release(cls, batch);
+				}
+			}
+
+			void flush() noexcept{
+				for(std::size_t i = 0; i < numSizeClasses; i++){
+					if(m_bins[i].count){
+						release(i, m_bins[i].count);
+					}
+				}
+			}
+
+			ThreadCache *next = nullptr;
+
+		private:
+			struct Bin{
+				void *head = nullptr;
+				Nat32 count = 0;
+			};
+
+			void release(std::size_t cls, Nat32 n) noexcept{
+				auto &&bin = m_bins[cls];
+
+				void *head = bin.head;
+				void *tail = head;
+
+				for(Nat32 i = 1; i < n; i++){
+					tail = *reinterpret_cast<void**>(tail);
+				}
+
+				bin.head = *reinterpret_cast<void**>(tail);
+				bin.count -= n;
+
+				centralLists[cls].insert(cls, head, n);
+			}
+
+			Bin m_bins[numSizeClasses];
+	};
+
+	// Thread caches live in their own spans and are recycled when threads exit
+	class ThreadCacheRegistry{
+		public:
+			constexpr ThreadCacheRegistry() noexcept = default;
+
+			ThreadCache *acquire(){
+				std::lock_guard lock(m_mut);
+
+				if(!m_free){
+					auto span = pageAllocator.allocSpan();
+					span->kind = SpanKind::small;
+					span->sizeClass = 0;
+					span->len = spanSize;
+
+					auto beg = reinterpret_cast<char*>(span) + spanHeaderSize;
+					const auto num = (spanSize - spanHeaderSize) / sizeof(ThreadCache);
+
+					for(std::size_t i = 0; i < num; i++){
+						auto cache = new(beg + (i * sizeof(ThreadCache))) ThreadCache;
+						cache->next = m_free;
+						m_free = cache;
+					}
+				}
+
+				auto ret = m_free;
+				m_free = ret->next;
+				ret->next = nullptr;
+				return ret;
+			}
+
+			void release(ThreadCache *cache) noexcept{
+				cache->flush();
+
+				std::lock_guard lock(m_mut);
+				cache->next = m_free;
+				m_free = cache;
+			}
+
+		private:
+			std::mutex m_mut;
+			ThreadCache *m_free = nullptr;
+	};
+
+	constinit ThreadCacheRegistry threadCaches;
+
+	thread_local ThreadCache *tlCache = nullptr;
+
+	// set once this thread's cache has been torn down, e.g. for allocations made
+	// by other thread_local destructors; those go straight to the central lists
+	thread_local bool tlCacheGone = false;
+
+	ThreadCache *createThreadCache(){
+		static pthread_key_t key = []{
+			pthread_key_t ret;
+			pthread_key_create(&ret, [](void *cache){
+				tlCache = nullptr;
+				tlCacheGone = true;
+				threadCaches.release(reinterpret_cast<ThreadCache*>(cache));
+			});
+			return ret;
+		}();
+
+		tlCache = threadCaches.acquire();
+		pthread_setspecific(key, tlCache);
+		return tlCache;
+	}
+
+	void *allocSmall(std::size_t n){
+		const auto cls = sizeClassIndex(n);
+
+		if(auto cache = tlCache){
+			return cache->alloc(cls);
+		}
+		else if(!tlCacheGone){
+			return createThreadCache()->alloc(cls);
+		}
+
+		void *ret;
+		centralLists[cls].remove(cls, 1, &ret);
+		return ret;
+	}
+
+	void freeSmall(std::size_t cls, void *ptr) noexcept{
+		if(auto cache = tlCache){
+			cache->free(cls, ptr);
+		}
+		else{
+			centralLists[cls].insert(cls, ptr, 1);
+		}
+	}
+
+	/*
+	 * Medium allocations share spans as runs of whole units. A run starting
+	 * at unit 0 begins after the span header. The used and start bitmaps in the
+	 * header give back a run's length on free, and spans with room left are
+	 * kept on a doubly linked list searched first fit, so a span leaves it in
+	 * constant time on free.
+	 */
+	class RunAllocator{
+		public:
+			constexpr RunAllocator() noexcept = default;
+
+			void *alloc(std::size_t n){
+				// a run at unit 0 shares its first unit with the header
+				const auto numUnits = Nat32((n + runSize - 1) / runSize);
+				const auto numFirstUnits = Nat32((n + spanHeaderSize + runSize - 1) / runSize);
+
+				std::lock_guard lock(m_mut);
+
+				auto span = m_partial.first;
+				Nat32 unit = 0, len = 0;
+
+				for(; span; span = span->next){
+					if(findRun(span->usedRuns, numUnits, numFirstUnits, unit, len)) break;
+				}
+
+				if(!span){
+					span = pageAllocator.allocSpan();
+					span->kind = SpanKind::runs;
+					span->sizeClass = 0;
+					span->len = spanSize;
+					span->owner = nullptr;
+					span->usedRuns = 0;
+					span->runStarts = 0;
+
+					m_partial.pushFront(span);
+
+					unit = 0;
+					len = numFirstUnits;
+				}
+
+				span->usedRuns |= runMask(unit, len);
+				span->runStarts |= Nat64(1) << unit;
+
+				if(span->usedRuns == ~Nat64(0)){
+					m_partial.remove(span);
+				}
+
+				return unit
+					? reinterpret_cast<char*>(span) + (unit * runSize)
+					: reinterpret_cast<char*>(span) + spanHeaderSize;
+			}
+
+			void free(SpanHeader *span, void *ptr) noexcept{
+				const auto unit = unitOf(span, ptr);
+
+				std::lock_guard lock(m_mut);
+
+				const bool wasFull = span->usedRuns == ~Nat64(0);
+
+				span->usedRuns &= ~runMask(unit, runLength(span, unit));
+				span->runStarts &= ~(Nat64(1) << unit);
+
+				if(span->usedRuns){
+					if(wasFull){
+						m_partial.pushFront(span);
+					}
+
+					return;
+				}
+
+				if(!wasFull){
+					m_partial.remove(span);
+				}
+
+				pageAllocator.freeSpan(span);
+			}
+
+			std::size_t usableSize(const SpanHeader *span, const void *ptr) noexcept{
+				const auto unit = unitOf(span, ptr);
+
+				// a neighbouring run may be half claimed, the bitmaps only read right under the lock
+				std::lock_guard lock(m_mut);
+				const auto bytes = runLength(span, unit) * runSize;
+				return unit ? bytes : bytes - spanHeaderSize;
+			}
+
+		private:
+			static Nat64 runMask(Nat32 unit, Nat32 len) noexcept{
+				return (len == 64 ? ~Nat64(0) : ((Nat64(1) << len) - 1)) << unit;
+			}
+
+			static Nat32 unitOf(const SpanHeader *span, const void *ptr) noexcept{
+				return Nat32((reinterpret_cast<std::uintptr_t>(ptr) - reinterpret_cast<std::uintptr_t>(span)) / runSize);
+			}
+
+			// up to the next run or free unit
+			static Nat32 runLength(const SpanHeader *span, Nat32 unit) noexcept{
+				const auto after = unit == 63 ? 0 : (~Nat64(0) << (unit + 1));
+				const auto stop = (span->runStarts | ~span->usedRuns) & after;
+				return stop ? Nat32(__builtin_ctzll(stop)) - unit : 64 - unit;
+			}
+
+			static bool findRun(Nat64 used, Nat32 numUnits, Nat32 numFirstUnits, Nat32 &unit, Nat32 &len) noexcept{
+				if(!(used & runMask(0, numFirstUnits))){
+					unit = 0;
+					len = numFirstUnits;
+					return true;
+				}
+
+				// bit i survives if units i to i + numUnits - 1 are all free
+				Nat64 fits = ~used;
+				for(Nat32 i = 1; i < numUnits && fits; i++){
+					fits &= ~used >> i;
+				}
+
+				fits &= ~Nat64(1); // unit 0 was checked with the header above
+				if(!fits) return false;
+
+				unit = Nat32(__builtin_ctzll(fits));
+				len = numUnits;
+				return true;
+			}
+
+			std::mutex m_mut;
+			SpanList m_partial;
+	};
+
+	constinit RunAllocator runAllocator;
+
+	void *allocLarge(std::size_t n){
+		if(n <= maxRunAllocSize){
+			return runAllocator.alloc(n);
+		}
+
+		const auto pageSize = PageAllocator::pageSize();
+		const auto len = ((n + spanHeaderSize + pageSize - 1) / pageSize) * pageSize;
+
+		auto span = reinterpret_cast<SpanHeader*>(PageAllocator::mapAligned(len));
+		span->kind = SpanKind::large;
+		span->sizeClass = 0;
+		span->len = len;
+		span->next = nullptr;
+
+		return reinterpret_cast<char*>(span) + spanHeaderSize;
+	}
+}
+
+/*
+ * Real-time heap
+ *
+ * A two-level segregated fit allocator (TLSF) for threads that can't afford
+ * an unbounded allocation. Free blocks are binned by the top bit of their
+ * size and then slBins linear steps below it; two bitmaps find a fitting
+ * non-empty bin with a couple of bit scans, and physical neighbours are
+ * merged on free through prevPhys links. Every operation is O(1).
+ *
+ * Regions are single spans owned by the heap, so sys::free finds the heap
+ * from the span header. A spinlock guards each heap since other threads may
+ * free into it; it's only ever contended by those cross-thread frees.
+ */
+
+namespace {
+	class TlsfHeap{
+		public:
+			static constexpr std::size_t alignLog2 = 4;
+			static constexpr std::size_t alignSize = std::size_t(1) << alignLog2;
+
+			static constexpr std::size_t slLog2 = 4;
+			static constexpr std::size_t slBins = std::size_t(1) << slLog2;
+
+			static constexpr std::size_t flShift = slLog2 + alignLog2;
+			static constexpr std::size_t smallBlockSize = std::size_t(1) << flShift;
+			static constexpr std::size_t flBins = 18 - flShift + 1; // 2^18 == spanSize
+
+			struct Block{
+				Block *prevPhys;
+				std::size_t sizeAndFlags;
+
+				// only valid while free
+				Block *nextFree, *prevFree;
+			};
+
+			static constexpr std::size_t blockHeaderSize = offsetof(Block, nextFree);
+			static constexpr std::size_t minBlockSize = sizeof(Block) - blockHeaderSize;
+
+			// first block plus the sentinel at the end of a region
+			static constexpr std::size_t maxBlockSize = spanSize - spanHeaderSize - (blockHeaderSize * 2);
+
+			// anything bigger goes to the general heap, keeps rounding in mappingSearch inside a region
+			static constexpr std::size_t maxAllocSize = spanSize / 4;
+
+			static_assert(spanSize == (std::size_t(1) << 18));
+			static_assert(blockHeaderSize == alignSize);
+
+			void *alloc(std::size_t n){
+				if(n > maxAllocSize) return nullptr;
+
+				const auto size = std::max(roundUp(n), minBlockSize);
+
+				lock();
+
+				auto block = findFree(size);
+				if(!block){
+					unlock();
+
+					// only reached when the reservation ran out
+					auto span = pageAllocator.allocSpan();
+
+					lock();
+					addRegion(span);
+					block = findFree(size);
+
+					if(!block){
+						unlock();
+						return nullptr;
+					}
+				}
+
+				removeFree(block);
+				auto ret = use(block, size);
+
+				unlock();
+				return ret;
+			}
+
+			void free(void *ptr) noexcept{
+				auto block = blockOf(ptr);
+
+				lock();
+
+				setFree(block, true);
+
+				if(isPrevFree(block)){
+					auto prev = block->prevPhys;
+					removeFree(prev);
+					setSize(prev, sizeOf(prev) + blockHeaderSize + sizeOf(block));
+					block = prev;
+				}
+
+				auto next = nextPhys(block);
+				if(isFree(next)){
+					removeFree(next);
+					setSize(block, sizeOf(block) + blockHeaderSize + sizeOf(next));
+					next = nextPhys(block);
+				}
+
+				next->prevPhys = block;
+				setPrevFree(next, true);
+				insertFree(block);
+
+				unlock();
+			}
+
+			static std::size_t usableSize(const void *ptr) noexcept{
+				return sizeOf(blockOf(const_cast<void*>(ptr)));
+			}
+
+			// make sure at least n bytes can be allocated without touching the page allocator
+			void reserve(std::size_t n){
+				while(m_reserved < n){
+					auto span = pageAllocator.allocSpan();
+
+					lock();
+					addRegion(span);
+					unlock();
+				}
+			}
+
+			TlsfHeap *nextHeap = nullptr;
+
+		private:
+			static constexpr std::size_t freeBit = 1;
+			static constexpr std::size_t prevFreeBit = 2;
+
+			static std::size_t roundUp(std::size_t n) noexcept{
+				return (n + (alignSize - 1)) & ~(alignSize - 1);
+			}
+
+			static unsigned fls(std::size_t n) noexcept{
+				return (sizeof(unsigned long long) * 8 - 1) - __builtin_clzll(n);
+			}
+
+			static Block *blockOf(void *ptr) noexcept{
+				return reinterpret_cast<Block*>(reinterpret_cast<char*>(ptr) - blockHeaderSize);
+			}
+
+			static void *payloadOf(Block *block) noexcept{
+				return reinterpret_cast<char*>(block) + blockHeaderSize;
+			}
+
+			static std::size_t sizeOf(const Block *block) noexcept{ return block->sizeAndFlags & ~(freeBit | prevFreeBit); }
+			static bool isFree(const Block *block) noexcept{ return block->sizeAndFlags & freeBit; }
+			static bool isPrevFree(const Block *block) noexcept{ return block->sizeAndFlags & prevFreeBit; }
+
+			static void setSize(Block *block, std::size_t size) noexcept{
+				block->sizeAndFlags = size | (block->sizeAndFlags & (freeBit | prevFreeBit));
+			}
+
+			static void setFree(Block *block, bool free) noexcept{
+				if(free) block->sizeAndFlags |= freeBit;
+				else block->sizeAndFlags &= ~freeBit;
+			}
+
+			static void setPrevFree(Block *block, bool free) noexcept{
+				if(free) block->sizeAndFlags |= prevFreeBit;
+				else block->sizeAndFlags &= ~prevFreeBit;
+			}
+
+			static Block *nextPhys(Block *block) noexcept{
+				return reinterpret_cast<Block*>(reinterpret_cast<char*>(payloadOf(block)) + sizeOf(block));
+			}
+
+			static void mapping(std::size_t size, unsigned &fl, unsigned &sl) noexcept{
+				if(size < smallBlockSize){
+					fl = 0;
+					sl = unsigned(size / (smallBlockSize / slBins));
+				}
+				else{
+					const auto f = fls(size);
+					sl = unsigned((size >> (f - slLog2)) ^ slBins);
+					fl = unsigned(f - (flShift - 1));
+				}
+			}
+
+			// like mapping, but rounded up so any block in the bin fits
+			static void mappingSearch(std::size_t size, unsigned &fl, unsigned &sl) noexcept{
+				if(size >= smallBlockSize){
+					size += (std::size_t(1) << (fls(size) - slLog2)) - 1;
+				}
+
+				mapping(size, fl, sl);
+			}
+
+			void lock() noexcept{
+				while(m_lock.test_and_set(std::memory_order_acquire)){
+					while(m_lock.test(std::memory_order_relaxed)){
+#if defined(__x86_64__) || defined(__i386__)
+						__builtin_ia32_pause();
+#endif
+					}
+				}
+			}
+
+			void unlock() noexcept{
+				m_lock.clear(std::memory_order_release);
+			}
+
+			Block *findFree(std::size_t size) noexcept{
+				unsigned fl, sl;
+				mappingSearch(size, fl, sl);
+
+				if(fl >= flBins) return nullptr;
+
+				auto slMap = m_slBitmap[fl] & (~0u << sl);
+				if(!slMap){
+					const auto flMap = (fl + 1) < 32 ? m_flBitmap & (~0u << (fl + 1)) : 0u;
+					if(!flMap) return nullptr;
+
+					fl = __builtin_ctz(flMap);
+					slMap = m_slBitmap[fl];
+				}
+
+				sl = __builtin_ctz(slMap);
+				return m_free[fl][sl];
+			}
+
+			void insertFree(Block *block) noexcept{
+				unsigned fl, sl;
+				mapping(sizeOf(block), fl, sl);
+
+				auto head = m_free[fl][sl];
+				block->nextFree = head;
+				block->prevFree = nullptr;
+				if(head) head->prevFree = block;
+
+				m_free[fl][sl] = block;
+				m_flBitmap |= 1u << fl;
+				m_slBitmap[fl] |= 1u << sl;
+			}
+
+			void removeFree(Block *block) noexcept{
+				unsigned fl, sl;
+				mapping(sizeOf(block), fl, sl);
+
+				if(block->prevFree) block->prevFree->nextFree = block->nextFree;
+				if(block->nextFree) block->nextFree->prevFree = block->prevFree;
+
+				if(m_free[fl][sl] == block){
+					m_free[fl][sl] = block->nextFree;
+
+					if(!block->nextFree){
+						m_slBitmap[fl] &= ~(1u << sl);
+						if(!m_slBitmap[fl]){
+							m_flBitmap &= ~(1u << fl);
+						}
+					}
+				}
+			}
+
+			// mark a free block used, splitting off the tail if it's worth keeping
+			void *use(Block *block, std::size_t size) noexcept{
+				const auto blockSize = sizeOf(block);
+
+				if(blockSize >= (size + blockHeaderSize + minBlockSize)){
+					auto rest = reinterpret_cast<Block*>(reinterpret_cast<char*>(payloadOf(block)) + size);
+					rest->prevPhys = block;
+					rest->sizeAndFlags = (blockSize - size - blockHeaderSize) | freeBit;
+					setSize(block, size);
+
+					auto next = nextPhys(rest);
+					next->prevPhys = rest;
+					setPrevFree(next, true);
+
+					insertFree(rest);
+				}
+				else{
+					setPrevFree(nextPhys(block), false);
+				}
+
+				setFree(block, false);
+				return payloadOf(block);
+			}
+
+			void addRegion(SpanHeader *span) noexcept;
+
+			std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+			Nat32 m_flBitmap = 0;
+			Nat32 m_slBitmap[flBins] = {};
+			Block *m_free[flBins][slBins] = {};
+			std::size_t m_reserved = 0;
+	};
+
+	static_assert(TlsfHeap::flBins <= 32 && TlsfHeap::slBins <= 32);
+
+	void TlsfHeap::addRegion(SpanHeader *span) noexcept{
+		span->kind = SpanKind::tlsf;
+		span->sizeClass = 0;
+		span->len = spanSize;
+		span->next = nullptr;
+		span->owner = this;
+
+		auto first = reinterpret_cast<Block*>(reinterpret_cast<char*>(span) + spanHeaderSize);
+		first->prevPhys = nullptr;
+		first->sizeAndFlags = maxBlockSize | freeBit;
+
+		auto sentinel = nextPhys(first);
+		sentinel->prevPhys = first;
+		sentinel->sizeAndFlags = prevFreeBit;
+
+		insertFree(first);
+		m_reserved += maxBlockSize;
+	}
+
+	// heaps outlive their threads, blocks can still be freed into them
+	std::mutex tlsfHeapsMut;
+	TlsfHeap *tlsfFreeHeaps = nullptr;
+
+	thread_local TlsfHeap *tlTlsfHeap = nullptr;
+}
+
+void sys::enableRealtimeHeap(std::size_t reserve){
+	if(tlTlsfHeap) return;
+
+	TlsfHeap *heap = nullptr;
+
+	{
+		std::lock_guard lock(tlsfHeapsMut);
+		if(tlsfFreeHeaps){
+			heap = tlsfFreeHeaps;
+			tlsfFreeHeaps = heap->nextHeap;
+		}
+	}
+
+	if(!heap){
+		heap = new(allocSmall(sizeof(TlsfHeap))) TlsfHeap;
+	}
+
+	heap->reserve(reserve);
+	tlTlsfHeap = heap;
+}
+
+void sys::disableRealtimeHeap() noexcept{
+	auto heap = std::exchange(tlTlsfHeap, nullptr);
+	if(!heap) return;
+
+	std::lock_guard lock(tlsfHeapsMut);
+	heap->nextHeap = tlsfFreeHeaps;
+	tlsfFreeHeaps = heap;
+}
+
+bool sys::realtimeHeapEnabled() noexcept{
+	return tlTlsfHeap != nullptr;
+}
+
+/*
+ * Allocation tracking
+ *
+ * With GPWE_MEMORY_TRACKING every block carries a 16 byte header holding its
+ * requested size and tag, so frees are credited to whoever allocated. All
+ * counters are relaxed atomics, one cache line per tag.
+ */
+
+namespace {
+	constexpr std::size_t numMemoryTags = std::size_t(ManagerKind::count) + 1;
+
+	thread_local ManagerKind tlMemoryTag = ManagerKind::count;
+
+#if GPWE_MEMORY_TRACKING
+	struct alignas(16) AllocHeader{
+		std::size_t size;
+		ManagerKind tag;
+	};
+
+	static_assert(sizeof(AllocHeader) == 16);
+
+	struct alignas(64) TagCounters{
+		std::atomic<std::size_t> liveBytes, liveCount, peakBytes;
+		std::atomic<Nat64> totalCount;
+	};
+
+	constinit TagCounters tagCounters[numMemoryTags] = {};
+
+	std::atomic<Nat64> curFrameAllocs = 0, lastFrameAllocs = 0;
+
+	void countAlloc(ManagerKind tag, std::size_t n) noexcept{
+		auto &&counters = tagCounters[std::size_t(tag)];
+
+		const auto live = counters.liveBytes.fetch_add(n, std::memory_order_relaxed) + n;
+		counters.liveCount.fetch_add(1, std::memory_order_relaxed);
+		counters.totalCount.fetch_add(1, std::memory_order_relaxed);
+
+		auto peak = counters.peakBytes.load(std::memory_order_relaxed);
+		while(live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)){}
+	}
+
+	void countFree(ManagerKind tag, std::size_t n) noexcept{
+		auto &&counters = tagCounters[std::size_t(tag)];
+		counters.liveBytes.fetch_sub(n, std::memory_order_relaxed);
+		counters.liveCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	// pool blocks count towards the tags but not the frame, they never touch the heap
+	void trackAlloc(AllocHeader *header, std::size_t n) noexcept{
+		header->size = n;
+		header->tag = tlMemoryTag;
+
+		countAlloc(header->tag, n);
+		curFrameAllocs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void trackFree(const AllocHeader *header) noexcept{
+		countFree(header->tag, header->size);
+	}
+
+	constexpr std::size_t allocHeaderSize = sizeof(AllocHeader);
+#else
+	constexpr std::size_t allocHeaderSize = 0;
+#endif
+
+	void *allocUntracked(std::size_t n){
+		if(auto heap = tlTlsfHeap){
+			if(auto ret = heap->alloc(n)){
+				return ret;
+			}
+		}
+
+		if(n <= maxSmallSize){
+			return allocSmall(n);
+		}
+
+		return allocLarge(n);
+	}
+
+	void freeUntracked(void *ptr) noexcept{
+		auto span = spanOf(ptr);
+
+		switch(span->kind){
+			case SpanKind::small:{
+				freeSmall(span->sizeClass, ptr);
+				break;
+			}
+
+			case SpanKind::runs:{
+				runAllocator.free(span, ptr);
+				break;
+			}
+
+			case SpanKind::large:{
+				PageAllocator::unmap(span, span->len);
+				break;
+			}
+
+			case SpanKind::tlsf:{
+				reinterpret_cast<TlsfHeap*>(span->owner)->free(ptr);
+				break;
+			}
+
+			default: break;
+		}
+	}
+}
+
+/*
+ * Object pools
+ *
+ * Each chunk is one span tagged SpanKind::pool with the pool as its owner,
+ * carved into equal blocks. The block size is kept in the span's sizeClass.
+ * Blocks have no room for an AllocHeader, so with GPWE_MEMORY_TRACKING they
+ * are counted against the memory tag that was current when their chunk was
+ * made.
+ */
+
+static_assert(std::size_t(ManagerKind::count) <= 0xff, "memory tags must fit a SpanHeader");
+
+PoolBase::PoolBase(std::size_t objSize, std::size_t objAlign) noexcept
+	: m_objSize((std::max({ objSize, sizeof(void*), objAlign }) + (objAlign - 1)) & ~(objAlign - 1))
+{
+	if(objAlign > spanHeaderSize || m_objSize > (spanSize - spanHeaderSize)){
+		std::fprintf(stderr, "Error in PoolBase: can't pool objects of size %zu align %zu\n", objSize, objAlign);
+		std::abort();
+	}
+}
+
+PoolBase::~PoolBase(){
+	if(m_numLive) return;
+
+	auto chunk = reinterpret_cast<SpanHeader*>(m_chunks);
+	while(chunk){
+		auto next = chunk->next;
+		pageAllocator.freeSpan(chunk);
+		chunk = next;
+	}
+}
+
+void PoolBase::lock() noexcept{
+	while(m_lock.test_and_set(std::memory_order_acquire)){
+		while(m_lock.test(std::memory_order_relaxed)){
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#endif
+		}
+	}
+}
+
+void PoolBase::unlock() noexcept{
+	m_lock.clear(std::memory_order_release);
+}
+
+void PoolBase::grow(){
+	auto span = pageAllocator.allocSpan();
+	span->kind = SpanKind::pool;
+	span->tag = Nat8(tlMemoryTag);
+	span->sizeClass = Nat32(m_objSize);
+	span->len = spanSize;
+	span->owner = this;
+
+	auto beg = reinterpret_cast<char*>(span) + spanHeaderSize;
+	const auto numObjs = (spanSize - spanHeaderSize) / m_objSize;
+
+	// link back to front so the lowest address is handed out first
+	for(std::size_t i = numObjs; i > 0; i--){
+		auto obj = beg + ((i - 1) * m_objSize);
+		*reinterpret_cast<void**>(obj) = m_free;
+		m_free = obj;
+	}
+
+	span->next = reinterpret_cast<SpanHeader*>(m_chunks);
+	m_chunks = span;
+	++m_numChunks;
+}
+
+void *PoolBase::alloc(){
+	lock();
+
+	if(!m_free){
+		grow();
+	}
+
+	auto ret = m_free;
+	m_free = *reinterpret_cast<void**>(ret);
+	++m_numLive;
+
+	unlock();
+
+#if GPWE_MEMORY_TRACKING
+	countAlloc(ManagerKind(spanOf(ret)->tag), m_objSize);
+#endif
+
+	return ret;
+}
+
+void PoolBase::free(void *ptr) noexcept{
+	if(!ptr) return;
+
+#if GPWE_MEMORY_TRACKING
+	countFree(ManagerKind(spanOf(ptr)->tag), m_objSize);
+#endif
+
+	lock();
+	*reinterpret_cast<void**>(ptr) = m_free;
+	m_free = ptr;
+	--m_numLive;
+	unlock();
+}
+
+void *sys::alloc(std::size_t n){
+#if GPWE_MEMORY_TRACKING
+	auto header = reinterpret_cast<AllocHeader*>(allocUntracked(n + allocHeaderSize));
+	trackAlloc(header, n);
+	return header + 1;
+#else
+	return allocUntracked(n);
+#endif
+}
+
+void sys::free(void *ptr){
+	if(!ptr) return;
+
+	// pooled blocks never went through sys::alloc, so have no tracking header
+	auto span = spanOf(ptr);
+	if(span->kind == SpanKind::pool){
+		reinterpret_cast<PoolBase*>(span->owner)->free(ptr);
+		return;
+	}
+
+#if GPWE_MEMORY_TRACKING
+	auto header = reinterpret_cast<AllocHeader*>(ptr) - 1;
+	trackFree(header);
+	ptr = header;
+#endif
+
+	freeUntracked(ptr);
+}
+
+std::size_t sys::allocSize(const void *ptr) noexcept{
+	if(!ptr) return 0;
+
+	auto span = spanOf(const_cast<void*>(ptr));
+
+	switch(span->kind){
+		case SpanKind::small: return sizeClassSizes[span->sizeClass] - allocHeaderSize;
+		case SpanKind::runs: return runAllocator.usableSize(span, reinterpret_cast<const char*>(ptr) - allocHeaderSize) - allocHeaderSize;
+		case SpanKind::large: return span->len - spanHeaderSize - allocHeaderSize;
+		case SpanKind::tlsf: return TlsfHeap::usableSize(reinterpret_cast<const char*>(ptr) - allocHeaderSize) - allocHeaderSize;
+		case SpanKind::pool: return span->sizeClass;
+		default: return 0;
+	}
+}
+
+sys::MemoryStats sys::memoryStats(ManagerKind kind) noexcept{
+	MemoryStats ret;
+
+#if GPWE_MEMORY_TRACKING
+	auto &&counters = tagCounters[std::min(std::size_t(kind), numMemoryTags - 1)];
+	ret.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	ret.liveCount = counters.liveCount.load(std::memory_order_relaxed);
+	ret.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+	ret.totalCount = counters.totalCount.load(std::memory_order_relaxed);
+#endif
+
+	return ret;
+}
+
+sys::MemoryStats sys::memoryStats() noexcept{
+	MemoryStats ret;
+
+	// peaks of different tags happen at different times, so this is only an upper bound
+	for(std::size_t i = 0; i < numMemoryTags; i++){
+		const auto stats = memoryStats(ManagerKind(i));
+		ret.liveBytes += stats.liveBytes;
+		ret.liveCount += stats.liveCount;
+		ret.peakBytes += stats.peakBytes;
+		ret.totalCount += stats.totalCount;
+	}
+
+	return ret;
+}
+
+std::uint64_t sys::frameAllocCount() noexcept{
+#if GPWE_MEMORY_TRACKING
+	return lastFrameAllocs.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+namespace {
+	class HeapResource final: public MemoryResource{
+		protected:
+			void *doAllocate(std::size_t n, std::size_t align) override{
+				if(align <= alignof(std::max_align_t)){
+					return sys::alloc(n);
+				}
+
+				// over-aligned, keep the real block just before the returned pointer
+				auto mem = reinterpret_cast<char*>(sys::alloc(n + align + sizeof(void*)));
+				auto addr = reinterpret_cast<std::uintptr_t>(mem + sizeof(void*));
+				auto ret = reinterpret_cast<void**>((addr + (align - 1)) & ~std::uintptr_t(align - 1));
+				ret[-1] = mem;
+				return ret;
+			}
+
+			void doDeallocate(void *ptr, std::size_t n, std::size_t align) noexcept override{
+				if(align <= alignof(std::max_align_t)){
+					sys::free(ptr);
+				}
+				else if(ptr){
+					sys::free(reinterpret_cast<void**>(ptr)[-1]);
+				}
+			}
+
+			bool doIsEqual(const MemoryResource &other) const noexcept override{
+				return dynamic_cast<const HeapResource*>(&other) != nullptr;
+			}
+	};
+
+	constinit HeapResource heapResource;
+}
+
+MemoryResource *sys::defaultResource() noexcept{
+	return &heapResource;
+}
+
+ManagerKind sys::memoryTag() noexcept{
+	return tlMemoryTag;
+}
+
+void sys::setMemoryTag(ManagerKind kind) noexcept{
+	tlMemoryTag = kind;
+}
+
+/*
+ * Frame arena behind sys::frameAlloc
+ *
+ * Each thread bumps through whole spans, with two sets of blocks selected by
+ * the parity of the frame index. A set is only recycled the first time its
+ * thread allocates in a later frame of the same parity, so anything handed
+ * out in frame N stays valid for all of frame N + 1. Requests too big for a
+ * span get a dedicated block that is returned to the heap on reset.
+ */
+
+namespace {
+	std::atomic<Nat64> frameCounter = 0;
+
+	constexpr Nat64 unpinnedFrame = ~Nat64(0);
+	thread_local Nat64 tlPinnedFrame = unpinnedFrame;
+
+	inline Nat64 currentFrame() noexcept{
+		if(tlPinnedFrame != unpinnedFrame) return tlPinnedFrame;
+		return frameCounter.load(std::memory_order_relaxed);
+	}
+
+	constexpr std::size_t frameBlockSize = spanSize - spanHeaderSize;
+
+	class FrameArena{
+		public:
+			~FrameArena(){
+				for(auto &&buf : m_bufs){
+					releaseBlocks(buf.blocks);
+				}
+
+				releaseBlocks(m_spare);
+			}
+
+			void *alloc(std::size_t n, std::size_t align){
+				const auto frame = currentFrame();
+				if(frame != m_frame){
+					advance(frame);
+				}
+
+				auto &&buf = m_bufs[frame & 1];
+
+				if(auto block = buf.blocks){
+					const auto base = reinterpret_cast<std::uintptr_t>(block + 1);
+					const auto ptr = (base + block->used + (align - 1)) & ~std::uintptr_t(align - 1);
+
+					if((ptr + n) <= (base + block->len)){
+						block->used = (ptr + n) - base;
+						return reinterpret_cast<void*>(ptr);
+					}
+				}
+
+				return allocSlow(buf, n, align);
+			}
+
+		private:
+			struct Block{
+				Block *next;
+				std::size_t len, used;
+				char pad[40];
+			};
+
+			static_assert(sizeof(Block) == 64);
+
+			struct Buffer{
+				Block *blocks = nullptr;
+			};
+
+			static void releaseBlocks(Block *block) noexcept{
+				while(block){
+					auto next = block->next;
+					freeUntracked(block);
+					block = next;
+				}
+			}
+
+			void *allocSlow(Buffer &buf, std::size_t n, std::size_t align){
+				const auto need = n + align + sizeof(Block);
+
+				Block *block;
+
+				if(need > frameBlockSize){
+					block = reinterpret_cast<Block*>(allocLarge(need));
+					block->len = need - sizeof(Block);
+				}
+				else if(m_spare){
+					block = m_spare;
+					m_spare = block->next;
+				}
+				else{
+					block = reinterpret_cast<Block*>(allocLarge(frameBlockSize));
+					block->len = frameBlockSize - sizeof(Block);
+				}
+
+				block->used = 0;
+
+				// oversized blocks go behind the current one so it keeps bumping
+				if(need > frameBlockSize && buf.blocks){
+					block->next = buf.blocks->next;
+					buf.blocks->next = block;
+				}
+				else{
+					block->next = buf.blocks;
+					buf.blocks = block;
+				}
+
+				const auto base = reinterpret_cast<std::uintptr_t>(block + 1);
+				const auto ptr = (base + (align - 1)) & ~std::uintptr_t(align - 1);
+				block->used = (ptr + n) - base;
+				return reinterpret_cast<void*>(ptr);
+			}
+
+			void reset(Buffer &buf) noexcept{
+				auto block = buf.blocks;
+				buf.blocks = nullptr;
+
+				while(block){
+					auto next = block->next;
+
+					if(block->len == (frameBlockSize - sizeof(Block))){
+						block->next = m_spare;
+						m_spare = block;
+					}
+					else{
+						freeUntracked(block);
+					}
+
+					block = next;
+				}
+			}
+
+			void advance(Nat64 frame) noexcept{
+				if((frame - m_frame) > 1){
+					reset(m_bufs[0]);
+					reset(m_bufs[1]);
+				}
+				else{
+					reset(m_bufs[frame & 1]);
+				}
+
+				m_frame = frame;
+			}
+
+			Buffer m_bufs[2];
+			Block *m_spare = nullptr;
+			Nat64 m_frame = 0;
+	};
+
+	thread_local FrameArena tlFrameArena;
+}
+
+void *sys::frameAlloc(std::size_t n, std::size_t align){
+	return tlFrameArena.alloc(n, align);
+}
+
+void sys::nextFrame() noexcept{
+#if GPWE_MEMORY_TRACKING
+	lastFrameAllocs.store(curFrameAllocs.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+#endif
+
+	frameCounter.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t sys::frameIndex() noexcept{
+	return currentFrame();
+}
+
+void sys::pinFrame(std::uint64_t frame) noexcept{
+	tlPinnedFrame = frame;
+}
+
+void sys::unpinFrame() noexcept{
+	tlPinnedFrame = unpinnedFrame;
+}
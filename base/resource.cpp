@@ -1,3 +1,4 @@
+#include "gpwe/util/Profiler.hpp"
 #include "gpwe/log.hpp"
 #include "gpwe/resource.hpp"
 
@@ -216,6 +217,8 @@ bool resource::Manager::mount(const fs::path &path, StrView dir, bool mountBefor
 }
 
 resource::Asset *resource::Manager::openFile(StrView path, Access access_){
+	GPWE_PROFILE_SCOPE("resource::openFile");
+
 	if(access_ == Access::write){
 		access_ = Access::readWrite;
 	}
@@ -492,6 +495,8 @@ UniquePtr<resource::Model> resource::Manager::createModelFileAsset(
 	Str path,
 	Vector<char> bytes
 ){
+	GPWE_PROFILE_SCOPE("resource::createModelFileAsset");
+
 	Assimp::Importer importer;
 
 	auto scene = importer.ReadFileFromMemory(
@@ -1,9 +1,10 @@
 #include <atomic>
+#include <cstdlib>
 #include <optional>
 #include <functional>
 #include <chrono>
 #include <filesystem>
-#include <list>
+#include <semaphore>
 
 namespace fs = std::filesystem;
 
@@ -13,8 +14,6 @@ using GPWEProc = void(*)();
 #define LIB_PREFIX
 #define LIB_EXT ".dll"
 #else
-#include <unistd.h>
-#include <sys/mman.h>
 #define LIB_PREFIX "lib"
 #define LIB_EXT ".so"
 #endif
@@ -22,6 +21,7 @@ using GPWEProc = void(*)();
 #include "FastNoise/FastNoise.h"
 
 #include "gpwe/util/Timer.hpp"
+#include "gpwe/util/Profiler.hpp"
 #include "gpwe/util/WorkQueue.hpp"
 
 #include "gpwe/config.hpp"
@@ -56,6 +56,13 @@ magic_t gpweMagic = nullptr;
 
 thread_local sys::Manager *gpweSysManager = nullptr;
 
+// the initialized manager, for threads that never had setManager called on them
+std::atomic<sys::Manager*> gpweGlobalSysManager = nullptr;
+
+static sys::Manager *anySysManager() noexcept{
+	return gpweSysManager ? gpweSysManager : gpweGlobalSysManager.load(std::memory_order_acquire);
+}
+
 log::Manager gpweDefaultLogManager;
 resource::Manager gpweResourceManager; // special, not a plugin
 
@@ -192,10 +199,48 @@ sys::Manager::Manager(){}
 sys::Manager::~Manager(){
 	m_appManager.reset();
 	m_uiManager.reset();
+	m_worldManager.reset();
 	m_physicsManager.reset();
 	m_renderManager.reset();
 	m_inputManager.reset();
+	m_timers.setJobSystem(nullptr);
+	m_jobSystem.reset();
 	gpweSysManager = nullptr;
+
+	auto self = this;
+	gpweGlobalSysManager.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+
+	// the last frames before shutdown, written once every zone has closed
+	if(!m_profileTracePath.empty()){
+		prof::frameMark();
+		prof::writeChromeTrace(m_profileTracePath);
+	}
+
+	if constexpr(sys::memoryTracking()){
+		reportLeaks();
+	}
+}
+
+void sys::Manager::reportLeaks(){
+	constexpr std::pair<ManagerKind, StrView> kinds[] = {
+		{ ManagerKind::input, "input" },
+		{ ManagerKind::render, "render" },
+		{ ManagerKind::physics, "physics" },
+		{ ManagerKind::world, "world" },
+		{ ManagerKind::ui, "ui" },
+		{ ManagerKind::app, "app" }
+	};
+
+	for(auto &&[kind, name] : kinds){
+		const auto stats = sys::memoryStats(kind);
+		if(stats.liveCount == 0) continue;
+
+		log::outLn(
+			log::Kind::warning,
+			"{} manager leaked {} bytes in {} allocations (peak {} bytes)",
+			name, stats.liveBytes, stats.liveCount, stats.peakBytes
+		);
+	}
 }
 
 void sys::Manager::loadPlugins(){
@@ -260,21 +305,273 @@ int sys::Manager::exec(PresentFn presentFn){
 		init();
 	}	
 
+	if(m_frameLatency > 0){
+		return execPipelined(presentFn);
+	}
+
 	while(m_running){
 		auto dt = ticker.tick();
 		update(dt);
-		presentFn();
+
+		{
+			FrameStats::Scope stats(m_frameStats, FrameStats::Stage::present);
+			presentFn();
+		}
+
+		m_framePacer.wait();
+	}
+
+	return 0;
+}
+
+int sys::Manager::execPipelined(PresentFn &presentFn){
+	static_assert(maxFrameLatency <= render::maxFrameSnapshots, "renderers keep too few snapshot slots");
+
+	const auto latency = m_frameLatency;
+
+	// slots the simulation may fill, and slots waiting to be rendered
+	std::counting_semaphore<maxFrameLatency> freeSlots(latency), readySlots(0);
+
+	Vector<render::FrameSnapshot> snapshots;
+	snapshots.reserve(latency);
+
+	for(Nat32 i = 0; i < latency; i++){
+		snapshots.emplace_back(render::FrameSnapshot{ 0, i, gpweCamera, 0.f });
+	}
+
+	std::atomic_bool simDone = false;
+
+	if(m_releaseRenderContext) m_releaseRenderContext();
+
+	m_pipelined = true;
+
+	Thread renderThread([&]{
+		gpweSysManager = this;
+		m_renderThreadId = std::this_thread::get_id();
+
+		// frame critical like the manager threads, keep allocation latency bounded
+		sys::enableRealtimeHeap();
+
+		if(m_acquireRenderContext) m_acquireRenderContext();
+
+		auto &&cmds = m_commandQueues[(std::size_t)ThreadIdx::render];
+		auto &&work = m_workQueues[(std::size_t)ThreadIdx::render];
+
+		Ticker ticker;
+		Nat64 frameNum = 0;
+
+		while(true){
+			// keep serving render calls while the simulation catches up
+			bool ready = false;
+			while(!(ready = readySlots.try_acquire_for(std::chrono::milliseconds(1))) && !simDone){
+				cmds.drain();
+				work.doWork();
+			}
+
+			if(!ready) break;
+
+			const auto &snap = snapshots[frameNum % latency];
+			sys::pinFrame(snap.frame);
+
+			m_renderManager->setSnapshot(&snap);
+			updateRender(ticker.tick(), &snap.camera);
+
+			{
+				FrameStats::Scope stats(m_frameStats, FrameStats::Stage::present);
+				presentFn();
+			}
+
+			freeSlots.release();
+			++frameNum;
+		}
+
+		m_renderManager->setSnapshot(nullptr);
+
+		// serve render calls that got in before this, any later ones are turned away
+		m_renderStopping = true;
+
+		while(true){
+			cmds.drain();
+			work.doWork();
+
+			if(!m_renderCalls.load()) break;
+			std::this_thread::yield();
+		}
+
+		sys::unpinFrame();
+
+		if(m_releaseRenderContext) m_releaseRenderContext();
+
+		sys::disableRealtimeHeap();
+
+		m_renderThreadId = std::thread::id();
+		gpweSysManager = nullptr;
+	});
+
+	renderThread.setName("gpwe-render");
+
+	Ticker ticker;
+	Nat64 frameNum = 0;
+
+	while(m_running){
+		auto dt = ticker.tick();
+		updateSimulation(dt);
+
+		freeSlots.acquire();
+
+		auto &&snap = snapshots[frameNum % latency];
+		snap.frame = sys::frameIndex();
+		snap.camera = gpweCamera;
+		snap.alpha = m_simClock.alpha();
+
+		{
+			GPWE_PROFILE_SCOPE("render::extract");
+			FrameStats::Scope stats(m_frameStats, FrameStats::Stage::render);
+			MemoryTagScope tag(ManagerKind::render);
+			m_renderManager->extract(snap);
+		}
+
+		readySlots.release();
+		++frameNum;
+
+		// pacing the simulation paces rendering too, it can't get ahead by more than the latency
+		m_framePacer.wait();
 	}
 
+	simDone = true;
+	renderThread.join();
+
+	m_pipelined = false;
+
+	if(m_acquireRenderContext) m_acquireRenderContext();
+
+	m_renderStopping = false;
+
 	return 0;
 }
 
+void sys::Manager::setFrameStatsLogInterval(std::chrono::seconds interval){
+	m_timers.cancel(m_frameStatsLog);
+	m_frameStatsLog = {};
+
+	if(interval.count() <= 0) return;
+
+	m_frameStatsLog = m_timers.every(
+		std::chrono::duration_cast<TimerWheel::Duration>(interval),
+		[this]{
+			auto report = m_frameStats.report();
+
+			// how much of each frame the pacer had to spare, negative when frames run long
+			if(m_framePacer.lastFrame().period > FramePacer::Duration::zero()){
+				auto ms = [](FramePacer::Duration dur){ return std::chrono::duration<double, std::milli>(dur).count(); };
+
+				const bool idle = m_framePacer.idle();
+
+				formatTo<"\npacer {:.0f}fps{}: slack {:.3f} work {:.3f} sleep jitter {:.3f} (ms)">(
+					report, idle ? m_framePacer.idleFps() : m_framePacer.targetFps(), idle ? " (idle)" : "",
+					ms(m_framePacer.averageSlack()), ms(m_framePacer.averageWork()), ms(m_framePacer.sleepJitter())
+				);
+			}
+
+			log::infoLn("{}", report);
+		}
+	);
+}
+
+void sys::Manager::setFrameLatency(Nat32 frames){
+	if(m_pipelined){
+		log::errorLn("Frame latency can't change while pipelined");
+		return;
+	}
+
+	m_frameLatency = std::min(frames, maxFrameLatency);
+}
+
 void sys::Manager::update(float dt){
-	m_inputManager->update(dt);
-	m_appManager->update(dt);
-	m_physicsManager->update(dt);
-	m_renderManager->update(dt);
-	m_renderManager->present(&gpweCamera);
+	updateSimulation(dt);
+	updateRender(dt, &gpweCamera);
+}
+
+void sys::Manager::updateSimulation(float dt){
+	sys::nextFrame();
+	GPWE_PROFILE_FRAME();
+	m_frameStats.endFrame();
+	GPWE_PROFILE_SCOPE("sys::updateSimulation");
+
+	// threads aren't split per manager yet, so drain their queues here
+	auto drainCommands = [this](ThreadIdx idx){
+		m_commandQueues[(std::size_t)idx].drain();
+		m_workQueues[(std::size_t)idx].doWork();
+	};
+
+	drainCommands(ThreadIdx::worker);
+
+	{
+		GPWE_PROFILE_SCOPE("input::update");
+		FrameStats::Scope stats(m_frameStats, FrameStats::Stage::input);
+		MemoryTagScope tag(ManagerKind::input);
+		m_inputManager->update(dt);
+
+		// replays run on the frame times they were recorded with
+		if(m_inputManager->replaying()){
+			dt = m_inputManager->replayDt();
+		}
+	}
+
+	const auto numSteps = m_simClock.advance(std::chrono::duration_cast<SimClock::Duration>(Seconds(dt)));
+	const auto stepDt = m_simClock.stepSeconds();
+
+	{
+		MemoryTagScope tag(ManagerKind::app);
+		drainCommands(ThreadIdx::app);
+
+		{
+			GPWE_PROFILE_SCOPE("sys::timers");
+			m_timers.advance(std::chrono::duration_cast<TimerWheel::Duration>(Seconds(dt)));
+		}
+
+		GPWE_PROFILE_SCOPE("app::update");
+		FrameStats::Scope stats(m_frameStats, FrameStats::Stage::app);
+		m_appManager->update(dt);
+	}
+
+	{
+		MemoryTagScope tag(ManagerKind::physics);
+		drainCommands(ThreadIdx::physics);
+	}
+
+	for(Nat32 i = 0; i < numSteps; i++){
+		{
+			GPWE_PROFILE_SCOPE("app::fixedUpdate");
+			FrameStats::Scope stats(m_frameStats, FrameStats::Stage::app);
+			MemoryTagScope tag(ManagerKind::app);
+			m_appManager->fixedUpdate(stepDt);
+		}
+
+		{
+			GPWE_PROFILE_SCOPE("physics::update");
+			FrameStats::Scope stats(m_frameStats, FrameStats::Stage::physics);
+			MemoryTagScope tag(ManagerKind::physics);
+			m_physicsManager->update(stepDt);
+		}
+	}
+}
+
+void sys::Manager::updateRender(float dt, const Camera *cam){
+	GPWE_PROFILE_SCOPE("sys::updateRender");
+	MemoryTagScope tag(ManagerKind::render);
+	m_commandQueues[(std::size_t)ThreadIdx::render].drain();
+	m_workQueues[(std::size_t)ThreadIdx::render].doWork();
+
+	{
+		GPWE_PROFILE_SCOPE("render::update");
+		FrameStats::Scope stats(m_frameStats, FrameStats::Stage::render);
+		m_renderManager->update(dt);
+	}
+
+	GPWE_PROFILE_SCOPE("render::present");
+	FrameStats::Scope stats(m_frameStats, FrameStats::Stage::present);
+	m_renderManager->present(cam);
 }
 
 void sys::Manager::setLogManager(Ptr<LogManager> manager){
@@ -299,6 +596,7 @@ void sys::Manager::setAppManager(Ptr<AppManager> manager){
 
 void sys::Manager::exit(){
 	m_running = false;
+	markDirty();
 }
 
 void sys::Manager::init(){
@@ -308,6 +606,7 @@ void sys::Manager::init(){
 	}
 
 	gpweSysManager = this;
+	gpweGlobalSysManager.store(this, std::memory_order_release);
 
 	//auto randNode = FastNoise::New<FastNoise::Value>(FastSIMD::Level_Null);
 
@@ -326,6 +625,11 @@ void sys::Manager::init(){
 	initBaseLibraries();
 	loadPlugins();
 
+	m_jobSystem = makeUnique<JobSystem>();
+	log::infoLn("Started {} job workers", m_jobSystem->numWorkers());
+
+	m_timers.setJobSystem(m_jobSystem.get());
+
 	auto ensureManager = [this](StrView kind_, auto &&manager, auto &&plugins){
 		if(manager) return;
 
@@ -353,307 +657,157 @@ void sys::Manager::init(){
 
 	/*
 	m_threads[(std::size_t)ThreadIdx::app]
-		= Thread([this]{ threadFn(m_appManager, m_workQueues[(std::size_t)ThreadIdx::app]); });
+		= Thread([this]{ threadFn(m_appManager, m_workQueues[(std::size_t)ThreadIdx::app], m_commandQueues[(std::size_t)ThreadIdx::app]); });
 	*/
 
-	if(m_logManager) m_logManager->init();
-	m_inputManager->init();
-	m_renderManager->init();
-	m_physicsManager->init();
-	m_worldManager->init();
-	m_uiManager->init();
-	m_appManager->init();
-
-	m_running = true;
-}
-
-void sys::Manager::setRenderSize(std::uint16_t w, std::uint16_t h){
-	m_rW = w;
-	m_rH = h;
-	if(m_renderManager){
-		m_renderManager->setRenderSize(w, h);
-	}
-}
-
-class Memory{
-	public:
-		Memory(void *ptr_, std::size_t size_)
-			: m_ptr(ptr_), m_len(size_){}
-
-		void *ptr() noexcept{ return m_ptr; }
-		const void *ptr() const noexcept{ return m_ptr; }
-
-		std::size_t size() const noexcept{ return m_len; }
-
-		void setPtr(void *ptr_) noexcept{ m_ptr = ptr_; }
-		void setSize(std::size_t size_) noexcept{ m_len = size_; }
-
-	private:
-		void *m_ptr;
-		std::size_t m_len;
-};
-
-class MemoryCompare{
-	public:
-		template<typename Lhs, typename Rhs>
-		bool operator()(const Lhs &lhs, const Rhs &rhs){
-			return getPtr(lhs) < getPtr(rhs);
-		}
-
-	private:
-		template<typename Mem>
-		static void *getPtr(Mem mem){
-			if constexpr(std::is_same_v<void*, Mem>){
-				return mem;
-			}
-			else{
-				return mem.ptr();
-			}
-		}
-};
-
-class MemoryRegion{
-	public:
-		MemoryRegion(): MemoryRegion(nullptr, 0){}
-
-		MemoryRegion(void *base_, std::size_t len_)
-			: m_base(base_), m_len(len_)
-			, m_freeMems{ Memory(base_, len_) }{}
-
-		void *base() noexcept{ return m_base; }
-
-		std::size_t size() const noexcept{ return m_len; }
-
-		Memory *allocMemory(std::size_t len, std::size_t align_){
-			for(auto it = m_freeMems.begin(); it != m_freeMems.end(); ++it){
-				auto &&mem = *it;
-
-				if(mem.size() < len) continue;
-
-				void *memPtr = mem.ptr();
-				std::size_t memLen = mem.size();
-
-				if(!std::align(align_, len, memPtr, memLen)){
-					continue;
-				}
-
-				if(memPtr != mem.ptr()){
-					auto newFreeLen = (std::uintptr_t)memPtr - (std::uintptr_t)mem.ptr();
-					m_freeMems.insert(it, Memory(mem.ptr(), newFreeLen));
-
-					mem.setPtr(memPtr);
-					mem.setSize(memLen);
-				}
-
-				auto rem = mem.size() - len;
-
-				auto insertIt = std::lower_bound(
-					m_usedMems.begin(), m_usedMems.end(),
-					mem.ptr(),
-					MemoryCompare{}
-				);
-
-				auto ret = m_usedMems.insert(insertIt, Memory(mem.ptr(), len));
-
-				if(rem > 0){
-					auto newFree = reinterpret_cast<char*>(mem.ptr()) + len;
-					mem.setPtr(newFree);
-					mem.setSize(rem);
-				}
-				else{
-					m_freeMems.erase(it);
-				}
-
-				return &(*ret);
-			}
-
-			return nullptr;
-		}
-
-		bool freeMemory(void *ptr){
-			auto it = binaryFind(m_usedMems, ptr, MemoryCompare{});
-			if(it == m_usedMems.end()) return false;
-
-			auto insertIt = std::upper_bound(
-				m_freeMems.begin(), m_freeMems.end(),
-				*it,
-				MemoryCompare{}
-			);
-
-			auto freeMemIt = m_freeMems.insert(insertIt, *it);
-
-			auto nextFreeMemIt = freeMemIt;
-			++nextFreeMemIt;
-
-			while(
-				nextFreeMemIt != m_freeMems.end() &&
-				nextFreeMemIt->ptr() == ((char*)freeMemIt->ptr() + freeMemIt->size())
-			){
-				freeMemIt->setSize(freeMemIt->size() + nextFreeMemIt->size());
-				m_freeMems.erase(nextFreeMemIt);
-				++nextFreeMemIt;
-			}
-
-			auto prevFreeMemIt = std::reverse_iterator{freeMemIt};
-			++prevFreeMemIt;
-
-			while(
-				prevFreeMemIt != std::reverse_iterator(m_freeMems.begin()--) &&
-				freeMemIt->ptr() == ((char*)prevFreeMemIt->ptr() + prevFreeMemIt->size())
-			){
-				freeMemIt->setPtr(prevFreeMemIt->ptr());
-				freeMemIt->setSize(freeMemIt->size() + prevFreeMemIt->size());
-				m_freeMems.erase(prevFreeMemIt.base());
-				++prevFreeMemIt;
-			}
+	auto initManager = [](ManagerKind kind, auto &&manager){
+		MemoryTagScope tag(kind);
+		manager->init();
+	};
 
-			return true;
+	if(m_logManager) initManager(ManagerKind::log, m_logManager);
+	initManager(ManagerKind::input, m_inputManager);
+	initManager(ManagerKind::render, m_renderManager);
+	initManager(ManagerKind::physics, m_physicsManager);
+	initManager(ManagerKind::world, m_worldManager);
+	initManager(ManagerKind::ui, m_uiManager);
+	initManager(ManagerKind::app, m_appManager);
+
+	// reproducible sessions: --record-input <file> or --replay-input <file>,
+	// --frame-stats <seconds> logs frame time percentiles periodically,
+	// --idle-fps <fps> drops to that rate once nothing has marked the frame dirty,
+	// --frame-latency <frames> pipelines rendering that many frames behind
+	for(int i = 1; i + 1 < m_argc; i++){
+		const StrView arg = m_argv[i];
+
+		if(arg == "--record-input"){
+			m_inputManager->startRecording(m_argv[++i]);
 		}
-
-		bool freeMemory(Memory mem){
-			return freeMemory(mem.ptr());
+		else if(arg == "--replay-input"){
+			m_inputManager->startReplay(m_argv[++i]);
 		}
-
-	private:
-		void *m_base;
-		std::size_t m_len;
-		std::list<Memory> m_freeMems;
-		std::list<Memory> m_usedMems;
-};
-
-class PageAllocator{
-	public:
-		explicit PageAllocator(std::size_t pageSize_ = getPageSize())
-			: m_pageSize(pageSize_)
-		{
-			m_regions.emplace_back(allocPages(1));
+		else if(arg == "--frame-stats"){
+			setFrameStatsLogInterval(std::chrono::seconds(std::atoi(m_argv[++i])));
 		}
-
-		~PageAllocator(){
-			for(auto &&region : m_regions){
-				freePages(region);
-			}
+		else if(arg == "--idle-fps"){
+			m_framePacer.setIdleFps(float(std::atof(m_argv[++i])));
 		}
-
-		Memory *alloc(std::size_t len, std::size_t align_){
-			// what's the correct log formula here?
-			// ceil ((log len)/(log pageSize)) ?
-
-			// TODO: think about a reasonable value for this
-			const std::size_t maxDepth = 6;
-
-			for(std::size_t i = 0; i < maxDepth; i++){
-				if(m_regions.size() == i){
-					m_regions.emplace_back(allocPages((1ul << i) * m_pageSize));
-				}
-
-				auto &&region = m_regions[i];
-
-				auto ret = region.allocMemory(len, align_);
-				if(ret){
-					m_ptrRegions[ret] = &region;
-					return ret;
-				}
-			}
-
-			return nullptr;
+		else if(arg == "--frame-latency"){
+			setFrameLatency(Nat32(std::max(std::atoi(m_argv[++i]), 0)));
 		}
+		else if(arg == "--profile-trace"){
+			m_profileTracePath = m_argv[++i];
 
-		void free(void *ptr){
-			if(!ptr) return;
-
-			auto it = m_ptrRegions.find(ptr);
-			if(it == m_ptrRegions.end()){
-				return;
+			if constexpr(!prof::enabled()){
+				log::warnLn("Built without GPWE_PROFILING, the profile trace will be empty");
 			}
-
-			it->second->freeMemory(ptr);
 		}
+	}
 
-	private:
-		static long getPageSize(){
-			return sysconf(_SC_PAGESIZE);
-		}
+	m_running = true;
+}
 
-		MemoryRegion allocPages(std::size_t n){
-			n = std::max<std::size_t>(1, n);
-			auto len = n * m_pageSize;
-			auto mem = mmap(
-				nullptr, len,
-				PROT_READ | PROT_WRITE,
-				MAP_PRIVATE | MAP_ANONYMOUS,
-				0, 0
-			);
-
-			if(mem == MAP_FAILED){
-				log::errorLn("Error in mmap: {}", strerror(errno));
-				std::exit(1);
-				//return MemoryRegion(nullptr, 0);
-			}
+void sys::Manager::setRenderSize(std::uint16_t w, std::uint16_t h){
+	m_rW = w;
+	m_rH = h;
+	if(m_renderManager){
+		m_renderManager->setRenderSize(w, h);
+	}
+}
 
-			return MemoryRegion{ mem, len };
-		}
+void sys::setManager(SysManager *manager) noexcept{
+	gpweSysManager = manager;
+}
 
-		void freePages(MemoryRegion region){
-			if(munmap(region.base(), region.size()) != 0){
-				log::warnLn("Error in munmap: {}", strerror(errno));
-			}
-		}
+void sys::update(float dt){
+	anySysManager()->update(dt);
+}
 
-		std::size_t m_pageSize;
+void sys::exit(){
+	if(auto manager = anySysManager()) manager->exit();
+}
 
-		// next is double of previous region size
-		// first region is a single page
-		std::vector<MemoryRegion> m_regions;
+Camera *sys::camera() noexcept{ return &gpweCamera; }
 
-		std::map<void*, MemoryRegion*> m_ptrRegions;
+// everything below works from any thread once init has run, and is null outside init and shutdown
 
-		std::mutex m_mut;
-} static pageAllocator;
+sys::Manager *sys::manager() noexcept{ return anySysManager(); }
 
-void *sys::alloc(std::size_t n){
-	return std::malloc(n);
-	//return pageAllocator.alloc(n, 1);
+UiManager *sys::uiManager() noexcept{
+	auto manager = anySysManager();
+	return manager ? manager->uiManager() : nullptr;
 }
 
-void sys::free(void *ptr){
-	std::free(ptr);
-	//pageAllocator.free(ptr);
+app::Manager *sys::appManager() noexcept{
+	auto manager = anySysManager();
+	return manager ? manager->appManager() : nullptr;
 }
 
-void sys::setManager(SysManager *manager) noexcept{
-	gpweSysManager = manager;
+JobSystem *sys::jobSystem() noexcept{
+	// jobs spawn jobs, so this has to work from the workers too
+	auto manager = anySysManager();
+	return manager ? manager->jobSystem() : nullptr;
 }
 
-void sys::update(float dt){
-	gpweSysManager->update(dt);
+SimClock *sys::simClock() noexcept{
+	auto manager = anySysManager();
+	return manager ? &manager->simClock() : nullptr;
 }
 
-void sys::exit(){
-	gpweSysManager->exit();
+TimerWheel *sys::timers() noexcept{
+	// job dispatched callbacks reschedule from the workers
+	auto manager = anySysManager();
+	return manager ? &manager->timers() : nullptr;
 }
 
-Camera *sys::camera() noexcept{ return &gpweCamera; }
+FramePacer *sys::framePacer() noexcept{
+	auto manager = anySysManager();
+	return manager ? &manager->framePacer() : nullptr;
+}
 
-sys::Manager *sys::manager() noexcept{ return gpweSysManager; }
+void sys::markDirty() noexcept{
+	// posted from input, loader and job threads, quietly does nothing before init
+	if(auto manager = anySysManager()) manager->markDirty();
+}
 
-UiManager *sys::uiManager() noexcept{ return gpweSysManager->uiManager(); }
+bool sys::renderCall(FnRef<void()> f){
+	if(auto manager = anySysManager()) return manager->renderCall(f);
+	f();
+	return true;
+}
 
-app::Manager *sys::appManager() noexcept{ return gpweSysManager->appManager(); }
+const FrameStats *sys::frameStats() noexcept{
+	auto manager = anySysManager();
+	return manager ? &manager->frameStats() : nullptr;
+}
 
-render::Manager *sys::renderManager() noexcept{ return gpweSysManager->renderManager(); }
+render::Manager *sys::renderManager() noexcept{
+	auto manager = anySysManager();
+	return manager ? manager->renderManager() : nullptr;
+}
 
-physics::Manager *sys::physicsManager() noexcept{ return gpweSysManager->physicsManager(); }
+physics::Manager *sys::physicsManager() noexcept{
+	auto manager = anySysManager();
+	return manager ? manager->physicsManager() : nullptr;
+}
 
-WorldManager *sys::worldManager() noexcept{ return gpweSysManager->worldManager(); }
+WorldManager *sys::worldManager() noexcept{
+	auto manager = anySysManager();
+	return manager ? manager->worldManager() : nullptr;
+}
 
 log::Manager *sys::logManager() noexcept{
-	if(!gpweSysManager) return &gpweDefaultLogManager;
+	// render thread, job workers and the like log through the engine's manager too
+	auto manager = anySysManager();
+	if(!manager) return &gpweDefaultLogManager;
 
-	auto ret = gpweSysManager->logManager();
+	auto ret = manager->logManager();
 	return ret ? ret : &gpweDefaultLogManager;
 }
 
-input::Manager *sys::inputManager() noexcept{ return gpweSysManager->inputManager(); }
+input::Manager *sys::inputManager() noexcept{
+	auto manager = anySysManager();
+	return manager ? manager->inputManager() : nullptr;
+}
 
 resource::Manager *sys::resourceManager() noexcept{ return &gpweResourceManager; }
@@ -4,9 +4,9 @@ using namespace gpwe;
 using namespace gpwe::ui;
 
 UniquePtr<Layout> ui::Manager::doCreateLayout(WidgetBase *parent){
-	return makeUnique<Layout>(parent);
+	return makeManaged<Layout>(parent);
 }
 
 UniquePtr<SolidColor> ui::Manager::doCreateSolidColor(WidgetBase *parent){
-	return makeUnique<SolidColor>(parent);
+	return makeManaged<SolidColor>(parent);
 }
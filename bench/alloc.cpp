@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gpwe/util/Allocator.hpp"
+#include "gpwe/util/Pool.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	struct GpweHeap{
+		static void *alloc(std::size_t n){ return sys::alloc(n); }
+		static void free(void *ptr){ sys::free(ptr); }
+	};
+
+	struct MallocHeap{
+		static void *alloc(std::size_t n){ return std::malloc(n); }
+		static void free(void *ptr){ std::free(ptr); }
+	};
+
+	struct PoolObj{ char data[256]; };
+
+	struct PoolHeap{
+		static void *alloc(std::size_t n){ return pool<PoolObj>().alloc(); }
+		static void free(void *ptr){ sys::free(ptr); }
+	};
+
+	template<typename Heap>
+	void allocFixed(Nat64 iters, std::size_t n){
+		for(Nat64 i = 0; i < iters; i++){
+			auto ptr = Heap::alloc(n);
+			bench::doNotOptimize(ptr);
+			Heap::free(ptr);
+		}
+	}
+
+	// One frame's worth of entity-like objects, freed in random order
+	template<typename Heap>
+	void allocEntityFrames(Nat64 iters){
+		constexpr std::size_t numObjs = 4096;
+		constexpr std::size_t sizes[] = { 48, 96, 160, 256, 512 };
+
+		static const auto order = []{
+			std::vector<std::size_t> ret(numObjs);
+			for(std::size_t i = 0; i < numObjs; i++) ret[i] = i;
+			std::shuffle(ret.begin(), ret.end(), std::mt19937(1337));
+			return ret;
+		}();
+
+		std::vector<void*> ptrs(numObjs);
+
+		for(Nat64 i = 0; i < iters; i++){
+			for(std::size_t j = 0; j < numObjs; j++){
+				const auto n = sizes[j % std::size(sizes)];
+				ptrs[j] = Heap::alloc(n);
+				std::memset(ptrs[j], 0, 16);
+			}
+
+			bench::clobberMemory();
+
+			for(auto idx : order){
+				Heap::free(ptrs[idx]);
+			}
+		}
+	}
+
+	// Short lived strings of varying length with a bounded history, like log lines
+	template<typename Heap>
+	void allocLogLines(Nat64 iters){
+		constexpr std::size_t historyLen = 256;
+
+		void *history[historyLen] = { nullptr };
+		std::minstd_rand rng(42);
+
+		for(Nat64 i = 0; i < iters; i++){
+			const std::size_t n = 24 + (rng() % 200);
+			auto line = reinterpret_cast<char*>(Heap::alloc(n));
+			std::memset(line, 'x', n);
+
+			auto &&slot = history[i % historyLen];
+			Heap::free(slot);
+			slot = line;
+		}
+
+		for(auto ptr : history){
+			Heap::free(ptr);
+		}
+	}
+
+	// growing containers through the engine allocator and std::allocator
+	template<typename Vec>
+	void allocVectorGrow(Nat64 iters){
+		for(Nat64 i = 0; i < iters; i++){
+			Vec vec;
+			for(Nat64 j = 0; j < 1024; j++){
+				vec.emplace_back(j);
+			}
+
+			bench::doNotOptimize(vec.data());
+		}
+	}
+
+	template<typename Heap>
+	void allocThreaded(Nat64 iters, std::size_t numThreads){
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads);
+
+		for(std::size_t i = 0; i < numThreads; i++){
+			threads.emplace_back([iters]{
+				void *ptrs[64];
+
+				for(Nat64 j = 0; j < iters; j += 64){
+					for(std::size_t k = 0; k < 64; k++){
+						ptrs[k] = Heap::alloc(16 + (k * 8));
+					}
+
+					bench::clobberMemory();
+
+					for(std::size_t k = 0; k < 64; k++){
+						Heap::free(ptrs[k]);
+					}
+				}
+			});
+		}
+
+		for(auto &&t : threads){
+			t.join();
+		}
+	}
+}
+
+GPWE_BENCH(allocFixed16Gpwe, "alloc/fixed-16/gpwe", 20'000'000){ allocFixed<GpweHeap>(iters, 16); }
+GPWE_BENCH(allocFixed16Malloc, "alloc/fixed-16/malloc", 20'000'000){ allocFixed<MallocHeap>(iters, 16); }
+
+GPWE_BENCH(allocFixed256Gpwe, "alloc/fixed-256/gpwe", 20'000'000){ allocFixed<GpweHeap>(iters, 256); }
+GPWE_BENCH(allocFixed256Malloc, "alloc/fixed-256/malloc", 20'000'000){ allocFixed<MallocHeap>(iters, 256); }
+GPWE_BENCH(allocFixed256Pool, "alloc/fixed-256/pool", 20'000'000){ allocFixed<PoolHeap>(iters, 256); }
+
+GPWE_BENCH(allocFixed4kGpwe, "alloc/fixed-4k/gpwe", 10'000'000){ allocFixed<GpweHeap>(iters, 4096); }
+GPWE_BENCH(allocFixed4kMalloc, "alloc/fixed-4k/malloc", 10'000'000){ allocFixed<MallocHeap>(iters, 4096); }
+
+GPWE_BENCH(allocEntitiesGpwe, "alloc/entity-frame/gpwe", 500){ allocEntityFrames<GpweHeap>(iters); }
+GPWE_BENCH(allocEntitiesMalloc, "alloc/entity-frame/malloc", 500){ allocEntityFrames<MallocHeap>(iters); }
+
+GPWE_BENCH(allocLogLinesGpwe, "alloc/log-lines/gpwe", 10'000'000){ allocLogLines<GpweHeap>(iters); }
+GPWE_BENCH(allocLogLinesMalloc, "alloc/log-lines/malloc", 10'000'000){ allocLogLines<MallocHeap>(iters); }
+
+GPWE_BENCH(allocVectorGpwe, "alloc/vector-grow/gpwe", 200'000){ allocVectorGrow<Vector<Nat64>>(iters); }
+GPWE_BENCH(allocVectorStd, "alloc/vector-grow/std", 200'000){ allocVectorGrow<std::vector<Nat64>>(iters); }
+
+GPWE_BENCH(allocThreaded4Gpwe, "alloc/threads-4/gpwe", 5'000'000){ allocThreaded<GpweHeap>(iters, 4); }
+GPWE_BENCH(allocThreaded4Malloc, "alloc/threads-4/malloc", 5'000'000){ allocThreaded<MallocHeap>(iters, 4); }
@@ -0,0 +1,45 @@
+#ifndef GPWE_BENCH_HPP
+#define GPWE_BENCH_HPP 1
+
+#include "gpwe/util/Vector.hpp"
+#include "gpwe/util/Str.hpp"
+#include "gpwe/util/types.hpp"
+
+namespace gpwe::bench{
+	using BenchFn = void(*)(Nat64 iters);
+
+	struct Bench{
+		StrView name;
+		Nat64 iters;
+		BenchFn fn;
+	};
+
+	Vector<Bench> &benches();
+
+	struct Registrar{
+		Registrar(StrView name, Nat64 iters, BenchFn fn){
+			benches().emplace_back(Bench{ name, iters, fn });
+		}
+	};
+
+	// keep the compiler from throwing away results
+	template<typename T>
+	inline void doNotOptimize(T &&val) noexcept{
+		asm volatile("" : : "r,m"(val) : "memory");
+	}
+
+	inline void clobberMemory() noexcept{
+		asm volatile("" : : : "memory");
+	}
+}
+
+/**
+ * @brief Define a benchmark run for n iterations.
+ * The body receives the iteration count as `iters`.
+ */
+#define GPWE_BENCH(id, name, n)\
+	static void gpweBench_##id(gpwe::Nat64);\
+	static gpwe::bench::Registrar gpweBenchReg_##id(name, n, gpweBench_##id);\
+	static void gpweBench_##id(gpwe::Nat64 iters)
+
+#endif // !GPWE_BENCH_HPP
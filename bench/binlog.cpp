@@ -0,0 +1,51 @@
+#include "gpwe/BinaryLog.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// big enough that the timed calls never drop, the writer only sees /dev/null;
+	// the timings include the writer draining everything on teardown
+	log::BinaryConfig benchConfig(){
+		log::BinaryConfig config;
+		config.path = "/dev/null";
+		config.bufferSize = 64 * 1024 * 1024;
+		return config;
+	}
+}
+
+GPWE_BENCH(binLogInts, "log/binary/ints-2", 1'000'000){
+	log::BinaryLog binLog(benchConfig());
+
+	for(Nat64 i = 0; i < iters; i++){
+		log::binInfoLn<"frame {} took {}ns">(i, i * 3);
+	}
+}
+
+GPWE_BENCH(binLogMixed, "log/binary/mixed-4", 1'000'000){
+	log::BinaryLog binLog(benchConfig());
+
+	const StrView name = "physics";
+
+	for(Nat64 i = 0; i < iters; i++){
+		log::binInfoLn<"{}: step {} dt {:.3f} ok {}">(name, i, 0.016 * i, (i & 1) == 0);
+	}
+}
+
+// what the same line costs to format on the calling thread
+GPWE_BENCH(formatInts, "log/format/ints-2", 1'000'000){
+	for(Nat64 i = 0; i < iters; i++){
+		auto str = format("frame {} took {}ns", i, i * 3);
+		bench::doNotOptimize(str);
+	}
+}
+
+GPWE_BENCH(formatMixed, "log/format/mixed-4", 1'000'000){
+	const StrView name = "physics";
+
+	for(Nat64 i = 0; i < iters; i++){
+		auto str = format("{}: step {} dt {:.3f} ok {}", name, i, 0.016 * i, (i & 1) == 0);
+		bench::doNotOptimize(str);
+	}
+}
@@ -0,0 +1,93 @@
+#include <thread>
+#include <vector>
+
+#include "gpwe/util/CommandQueue.hpp"
+#include "gpwe/util/WorkQueue.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// producers post small commands while the consumer drains in batches
+	template<std::size_t NumProducers>
+	void commandQueuePost(Nat64 iters){
+		CommandQueue queue(4096);
+		Nat64 acc = 0;
+
+		std::vector<std::thread> producers;
+		for(std::size_t i = 0; i < NumProducers; i++){
+			producers.emplace_back([&queue, &acc, iters]{
+				for(Nat64 j = 0; j < iters / NumProducers; j++){
+					queue.post([&acc, j]{ acc += j; });
+				}
+			});
+		}
+
+		Nat64 numRun = 0;
+		const auto total = (iters / NumProducers) * NumProducers;
+
+		while(numRun < total){
+			if(auto n = queue.drain(256)){
+				numRun += n;
+			}
+			else{
+				std::this_thread::yield();
+			}
+		}
+
+		for(auto &&t : producers){
+			t.join();
+		}
+
+		bench::doNotOptimize(acc);
+	}
+
+	// WithFuture uses emplace, otherwise the fire-and-forget post
+	template<std::size_t NumProducers, bool WithFuture>
+	void workQueuePost(Nat64 iters){
+		WorkQueue queue;
+		Nat64 acc = 0;
+
+		std::vector<std::thread> producers;
+		for(std::size_t i = 0; i < NumProducers; i++){
+			producers.emplace_back([&queue, &acc, iters]{
+				for(Nat64 j = 0; j < iters / NumProducers; j++){
+					if constexpr(WithFuture){
+						queue.emplace([&acc, j]{ acc += j; });
+					}
+					else{
+						queue.post([&acc, j]{ acc += j; });
+					}
+				}
+			});
+		}
+
+		Nat64 numRun = 0;
+		const auto total = (iters / NumProducers) * NumProducers;
+
+		while(numRun < total){
+			if(auto n = queue.doWork(256)){
+				numRun += n;
+			}
+			else{
+				std::this_thread::yield();
+			}
+		}
+
+		for(auto &&t : producers){
+			t.join();
+		}
+
+		bench::doNotOptimize(acc);
+	}
+}
+
+GPWE_BENCH(commandQueue1, "commands/producers-1/command-queue", 2'000'000){ commandQueuePost<1>(iters); }
+GPWE_BENCH(commandQueue4, "commands/producers-4/command-queue", 2'000'000){ commandQueuePost<4>(iters); }
+
+GPWE_BENCH(workQueue1, "commands/producers-1/work-queue", 2'000'000){ workQueuePost<1, true>(iters); }
+GPWE_BENCH(workQueue4, "commands/producers-4/work-queue", 2'000'000){ workQueuePost<4, true>(iters); }
+
+GPWE_BENCH(workQueuePost1, "commands/producers-1/work-queue-post", 2'000'000){ workQueuePost<1, false>(iters); }
+GPWE_BENCH(workQueuePost4, "commands/producers-4/work-queue-post", 2'000'000){ workQueuePost<4, false>(iters); }
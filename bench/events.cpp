@@ -0,0 +1,51 @@
+#include "gpwe/util/Event.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// one emit reaching NumSlots listeners
+	template<std::size_t NumSlots>
+	void eventEmit(Nat64 iters){
+		Event<Nat64> ev;
+		Nat64 acc = 0;
+
+		for(std::size_t i = 0; i < NumSlots; i++){
+			ev.addFn([&acc](Nat64 x){ acc += x; });
+		}
+
+		for(Nat64 i = 0; i < iters; i++){
+			ev.emit(i);
+		}
+
+		bench::doNotOptimize(acc);
+	}
+
+	// posts flushed in batches, as a subsystem publishing to the main thread would
+	template<std::size_t NumSlots>
+	void eventPostFlush(Nat64 iters){
+		Event<Nat64> ev;
+		ev.setQueueCapacity(1024);
+
+		Nat64 acc = 0;
+
+		for(std::size_t i = 0; i < NumSlots; i++){
+			ev.addFn([&acc](Nat64 x){ acc += x; });
+		}
+
+		for(Nat64 i = 0; i < iters; i++){
+			ev.post(i);
+			if((i & 255) == 255) ev.flush();
+		}
+
+		ev.flush();
+		bench::doNotOptimize(acc);
+	}
+}
+
+GPWE_BENCH(eventEmit1, "events/emit/slots-1", 10'000'000){ eventEmit<1>(iters); }
+GPWE_BENCH(eventEmit64, "events/emit/slots-64", 200'000){ eventEmit<64>(iters); }
+
+GPWE_BENCH(eventPost1, "events/post-flush/slots-1", 5'000'000){ eventPostFlush<1>(iters); }
+GPWE_BENCH(eventPost64, "events/post-flush/slots-64", 200'000){ eventPostFlush<64>(iters); }
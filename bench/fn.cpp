@@ -0,0 +1,80 @@
+#include <functional>
+
+#include "gpwe/util/Fn.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	struct SmallCapture{
+		Nat64 vals[2];
+	};
+
+	struct LargeCapture{
+		Nat64 vals[8];
+	};
+
+	template<typename Func>
+	void fnCall(Nat64 iters){
+		Nat64 k = 3;
+		Func f = [k](Nat64 x){ return x * k; };
+
+		Nat64 acc = 0;
+		for(Nat64 i = 0; i < iters; i++){
+			bench::doNotOptimize(f);
+			acc += f(i);
+		}
+
+		bench::doNotOptimize(acc);
+	}
+
+	template<typename Func, typename Capture>
+	void fnConstruct(Nat64 iters){
+		Capture cap{};
+		for(Nat64 i = 0; i < iters; i++){
+			cap.vals[0] = i;
+			Func f = [cap](Nat64 x){ return x + cap.vals[0]; };
+			bench::doNotOptimize(f);
+		}
+	}
+
+	template<typename Func>
+	void fnMove(Nat64 iters){
+		LargeCapture cap{};
+		Func a = [cap](Nat64 x){ return x + cap.vals[0]; };
+
+		for(Nat64 i = 0; i < iters; i++){
+			Func b = std::move(a);
+			bench::doNotOptimize(b);
+			a = std::move(b);
+		}
+	}
+
+	void fnRefCall(Nat64 iters){
+		Nat64 k = 3;
+		auto lam = [k](Nat64 x){ return x * k; };
+		FnRef<Nat64(Nat64)> f = lam;
+
+		Nat64 acc = 0;
+		for(Nat64 i = 0; i < iters; i++){
+			bench::doNotOptimize(f);
+			acc += f(i);
+		}
+
+		bench::doNotOptimize(acc);
+	}
+}
+
+GPWE_BENCH(fnCallGpwe, "fn/call/gpwe", 100'000'000){ fnCall<Fn<Nat64(Nat64)>>(iters); }
+GPWE_BENCH(fnCallStd, "fn/call/std", 100'000'000){ fnCall<std::function<Nat64(Nat64)>>(iters); }
+GPWE_BENCH(fnCallRef, "fn/call/ref", 100'000'000){ fnRefCall(iters); }
+
+GPWE_BENCH(fnSmallGpwe, "fn/construct-small/gpwe", 50'000'000){ fnConstruct<Fn<Nat64(Nat64)>, SmallCapture>(iters); }
+GPWE_BENCH(fnSmallStd, "fn/construct-small/std", 50'000'000){ fnConstruct<std::function<Nat64(Nat64)>, SmallCapture>(iters); }
+
+GPWE_BENCH(fnLargeGpwe, "fn/construct-large/gpwe", 20'000'000){ fnConstruct<Fn<Nat64(Nat64)>, LargeCapture>(iters); }
+GPWE_BENCH(fnLargeStd, "fn/construct-large/std", 20'000'000){ fnConstruct<std::function<Nat64(Nat64)>, LargeCapture>(iters); }
+
+GPWE_BENCH(fnMoveGpwe, "fn/move-large/gpwe", 50'000'000){ fnMove<Fn<Nat64(Nat64)>>(iters); }
+GPWE_BENCH(fnMoveStd, "fn/move-large/std", 50'000'000){ fnMove<std::function<Nat64(Nat64)>>(iters); }
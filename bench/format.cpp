@@ -0,0 +1,65 @@
+#include <locale>
+
+#include "gpwe/log.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	constexpr char lineFmt[] = "entity {} in cell ({}, {}) mesh '{}'";
+
+	const StrView meshName = "assets/meshes/terrain/chunk.gltf";
+}
+
+// how format used to work: a named locale built and a Str grown per call,
+// "C" standing in for en_US.UTF-8 which isn't installed everywhere
+GPWE_BENCH(formatLocalePerCall, "format/str/locale-per-call", 200'000){
+	for(Nat64 i = 0; i < iters; i++){
+		const Int32 x = i & 255, y = -Int32(i & 127);
+
+		Str str;
+		fmt::vformat_to(std::back_inserter(str), std::locale("C"), lineFmt, fmt::make_format_args(i, x, y, meshName));
+		bench::doNotOptimize(str);
+	}
+}
+
+GPWE_BENCH(formatStr, "format/str/cached-locale", 1'000'000){
+	for(Nat64 i = 0; i < iters; i++){
+		auto str = format(fmt::string_view(lineFmt), i, Int32(i & 255), -Int32(i & 127), meshName);
+		bench::doNotOptimize(str);
+	}
+}
+
+GPWE_BENCH(formatChecked, "format/str/checked", 1'000'000){
+	for(Nat64 i = 0; i < iters; i++){
+		auto str = format<"entity {} in cell ({}, {}) mesh '{}'">(i, Int32(i & 255), -Int32(i & 127), meshName);
+		bench::doNotOptimize(str);
+	}
+}
+
+GPWE_BENCH(formatFixed, "format/to/fixed-buffer", 1'000'000){
+	char buf[128];
+
+	for(Nat64 i = 0; i < iters; i++){
+		auto str = formatTo(buf, lineFmt, i, Int32(i & 255), -Int32(i & 127), meshName);
+		bench::doNotOptimize(str);
+	}
+}
+
+GPWE_BENCH(formatAppend, "format/to/reused-str", 1'000'000){
+	Str line;
+
+	for(Nat64 i = 0; i < iters; i++){
+		line.clear();
+		formatTo(line, lineFmt, i, Int32(i & 255), -Int32(i & 127), meshName);
+		bench::doNotOptimize(line);
+	}
+}
+
+GPWE_BENCH(formatScratch, "format/to/scratch", 1'000'000){
+	for(Nat64 i = 0; i < iters; i++){
+		auto str = formatScratch(lineFmt, i, Int32(i & 255), -Int32(i & 127), meshName);
+		bench::doNotOptimize(str);
+	}
+}
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "gpwe/util/JobSystem.hpp"
+#include "gpwe/util/WorkQueue.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// roughly a microsecond of work, about what a small update job costs
+	inline Nat64 busyWork(Nat64 seed) noexcept{
+		double acc = double(seed);
+		for(int i = 0; i < 256; i++){
+			acc = std::sqrt(acc + i) * 1.0001;
+		}
+
+		return Nat64(acc);
+	}
+
+	// iters is the total number of jobs, spread over N threads including the caller.
+	// counts above the core count oversubscribe, which is worth seeing too
+	template<std::size_t NumThreads>
+	void jobsFlat(Nat64 iters){
+		JobSystem jobs(NumThreads - 1);
+		JobCounter counter;
+
+		for(Nat64 i = 0; i < iters; i++){
+			jobs.run([i]{ bench::doNotOptimize(busyWork(i)); }, counter);
+		}
+
+		jobs.wait(counter);
+	}
+
+	// recursive fork/join, every job splits in two until a leaf
+	void forkJoin(JobSystem &jobs, Nat64 begin, Nat64 end){
+		if((end - begin) <= 64){
+			for(auto i = begin; i < end; i++){
+				bench::doNotOptimize(busyWork(i));
+			}
+
+			return;
+		}
+
+		const auto mid = begin + ((end - begin) / 2);
+
+		JobCounter counter;
+		jobs.run([&jobs, begin, mid]{ forkJoin(jobs, begin, mid); }, counter);
+		forkJoin(jobs, mid, end);
+		jobs.wait(counter);
+	}
+
+	template<std::size_t NumThreads>
+	void jobsForkJoin(Nat64 iters){
+		JobSystem jobs(NumThreads - 1);
+		forkJoin(jobs, 0, iters);
+	}
+
+	// the old way, workers contending on a single locked queue
+	template<std::size_t NumThreads>
+	void workQueueFlat(Nat64 iters){
+		WorkQueue queue;
+
+		for(Nat64 i = 0; i < iters; i++){
+			queue.emplace([i]{ bench::doNotOptimize(busyWork(i)); });
+		}
+
+		std::vector<std::thread> threads;
+		for(std::size_t i = 1; i < NumThreads; i++){
+			threads.emplace_back([&queue]{ while(queue.doWork(1)); });
+		}
+
+		while(queue.doWork(1));
+
+		for(auto &&t : threads){
+			t.join();
+		}
+	}
+}
+
+GPWE_BENCH(jobsFlat1, "jobs/flat/threads-1", 200'000){ jobsFlat<1>(iters); }
+GPWE_BENCH(jobsFlat2, "jobs/flat/threads-2", 200'000){ jobsFlat<2>(iters); }
+GPWE_BENCH(jobsFlat4, "jobs/flat/threads-4", 200'000){ jobsFlat<4>(iters); }
+GPWE_BENCH(jobsFlat8, "jobs/flat/threads-8", 200'000){ jobsFlat<8>(iters); }
+GPWE_BENCH(jobsFlat16, "jobs/flat/threads-16", 200'000){ jobsFlat<16>(iters); }
+
+GPWE_BENCH(jobsForkJoin1, "jobs/fork-join/threads-1", 200'000){ jobsForkJoin<1>(iters); }
+GPWE_BENCH(jobsForkJoin2, "jobs/fork-join/threads-2", 200'000){ jobsForkJoin<2>(iters); }
+GPWE_BENCH(jobsForkJoin4, "jobs/fork-join/threads-4", 200'000){ jobsForkJoin<4>(iters); }
+GPWE_BENCH(jobsForkJoin8, "jobs/fork-join/threads-8", 200'000){ jobsForkJoin<8>(iters); }
+GPWE_BENCH(jobsForkJoin16, "jobs/fork-join/threads-16", 200'000){ jobsForkJoin<16>(iters); }
+
+GPWE_BENCH(workQueueFlat1, "jobs/flat-workqueue/threads-1", 200'000){ workQueueFlat<1>(iters); }
+GPWE_BENCH(workQueueFlat4, "jobs/flat-workqueue/threads-4", 200'000){ workQueueFlat<4>(iters); }
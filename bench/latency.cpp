@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "gpwe/util/Allocator.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+/*
+ * Worst-case latency stress test
+ *
+ * A frame-like thread keeps a few thousand blocks of mixed sizes alive and
+ * times every single alloc and free, while background threads hammer the
+ * general heap. Reports the median, 99.9th percentile and worst case.
+ */
+
+namespace {
+	constexpr Nat64 latencyIters = 2'000'000;
+
+	struct GpweHeap{
+		static constexpr StrView name = "gpwe";
+		static void begin(){}
+		static void end(){}
+	};
+
+	struct TlsfHeap{
+		static constexpr StrView name = "tlsf";
+		static void begin(){ sys::enableRealtimeHeap(16 * 1024 * 1024); }
+		static void end(){ sys::disableRealtimeHeap(); }
+	};
+
+	struct MallocHeap{
+		static constexpr StrView name = "malloc";
+		static void begin(){}
+		static void end(){}
+	};
+
+	template<typename Heap>
+	void *heapAlloc(std::size_t n){
+		if constexpr(std::is_same_v<Heap, MallocHeap>) return std::malloc(n);
+		else return sys::alloc(n);
+	}
+
+	template<typename Heap>
+	void heapFree(void *ptr){
+		if constexpr(std::is_same_v<Heap, MallocHeap>) std::free(ptr);
+		else sys::free(ptr);
+	}
+
+	struct LatencyStats{
+		Nat64 median, p999, worst;
+	};
+
+	LatencyStats summarize(std::vector<Nat32> &samples){
+		if(samples.empty()) return { 0, 0, 0 };
+
+		auto nth = [&samples](double q){
+			auto it = samples.begin() + std::size_t(q * double(samples.size() - 1));
+			std::nth_element(samples.begin(), it, samples.end());
+			return Nat64(*it);
+		};
+
+		const auto worst = *std::max_element(samples.begin(), samples.end());
+		return { nth(0.5), nth(0.999), worst };
+	}
+
+	template<typename Heap>
+	void allocLatency(Nat64 iters){
+		using Clock = std::chrono::steady_clock;
+
+		constexpr std::size_t maxLive = 4096;
+		// leave a core for the measured thread, otherwise we only measure preemption
+		const std::size_t numNoiseThreads = std::min<std::size_t>(3, std::max(1u, std::thread::hardware_concurrency()) - 1);
+
+		std::atomic_bool done = false;
+		std::vector<std::thread> noise;
+
+		for(std::size_t i = 0; i < numNoiseThreads; i++){
+			noise.emplace_back([&done, i]{
+				std::minstd_rand rng(i + 1);
+				void *ptrs[256] = { nullptr };
+
+				while(!done.load(std::memory_order_relaxed)){
+					auto &&slot = ptrs[rng() % std::size(ptrs)];
+					heapFree<Heap>(slot);
+					slot = heapAlloc<Heap>(16 + (rng() % 8192));
+				}
+
+				for(auto ptr : ptrs) heapFree<Heap>(ptr);
+			});
+		}
+
+		std::vector<Nat32> allocNs, freeNs;
+		allocNs.reserve(iters);
+		freeNs.reserve(iters);
+
+		std::vector<void*> live;
+		live.reserve(maxLive);
+
+		std::minstd_rand rng(1337);
+
+		Heap::begin();
+
+		for(Nat64 i = 0; i < iters; i++){
+			if(live.size() < maxLive && (live.empty() || (rng() & 1))){
+				const std::size_t n = (rng() % 16) == 0 ? 4096 + (rng() % 60000) : 16 + (rng() % 512);
+
+				const auto start = Clock::now();
+				auto ptr = heapAlloc<Heap>(n);
+				const auto end = Clock::now();
+
+				std::memset(ptr, 0, std::min<std::size_t>(n, 64));
+				live.emplace_back(ptr);
+				allocNs.emplace_back(Nat32(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+			}
+			else{
+				const auto idx = rng() % live.size();
+				auto ptr = live[idx];
+				live[idx] = live.back();
+				live.pop_back();
+
+				const auto start = Clock::now();
+				heapFree<Heap>(ptr);
+				const auto end = Clock::now();
+
+				freeNs.emplace_back(Nat32(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+			}
+		}
+
+		for(auto ptr : live) heapFree<Heap>(ptr);
+
+		Heap::end();
+
+		done = true;
+		for(auto &&t : noise) t.join();
+
+		if(iters != latencyIters) return;
+
+		const auto allocStats = summarize(allocNs);
+		const auto freeStats = summarize(freeNs);
+
+		fmt::print(
+			"  {:<8} alloc p50 {:>5} p99.9 {:>6} max {:>8} | free p50 {:>5} p99.9 {:>6} max {:>8} (ns)\n",
+			Heap::name,
+			allocStats.median, allocStats.p999, allocStats.worst,
+			freeStats.median, freeStats.p999, freeStats.worst
+		);
+	}
+}
+
+GPWE_BENCH(latencyGpwe, "latency/gpwe", latencyIters){ allocLatency<GpweHeap>(iters); }
+GPWE_BENCH(latencyTlsf, "latency/tlsf", latencyIters){ allocLatency<TlsfHeap>(iters); }
+GPWE_BENCH(latencyMalloc, "latency/malloc", latencyIters){ allocLatency<MallocHeap>(iters); }
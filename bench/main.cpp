@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "fmt/format.h"
+
+#include "gpwe/memory.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+Vector<bench::Bench> &bench::benches(){
+	static Vector<Bench> ret;
+	return ret;
+}
+
+namespace {
+	using BenchClock = std::chrono::steady_clock;
+
+	struct Options{
+		StrView filter;
+		std::size_t reps = 5;
+		const char *jsonPath = nullptr;
+		const char *baselinePath = nullptr;
+		double threshold = 0.1; // relative slowdown counted as a regression
+	};
+
+	// times in ns/iter
+	struct Result{
+		Str name;
+		Nat64 iters = 0;
+		std::size_t reps = 0;
+		double median = 0.0, mad = 0.0, min = 0.0;
+		double allocs = 0.0; // per iteration
+	};
+
+	double medianOf(Vector<double> vals){
+		std::sort(vals.begin(), vals.end());
+
+		const auto n = vals.size();
+		if(n == 0) return 0.0;
+
+		return n % 2 ? vals[n / 2] : (vals[n / 2 - 1] + vals[n / 2]) * 0.5;
+	}
+
+	Result runBench(const bench::Bench &b, std::size_t reps){
+		// warm caches, page in memory
+		b.fn(std::max<Nat64>(1, b.iters / 10));
+
+		Vector<double> times;
+		times.reserve(reps);
+
+		const auto allocsBefore = sys::memoryStats().totalCount;
+
+		for(std::size_t i = 0; i < reps; i++){
+			const auto start = BenchClock::now();
+			b.fn(b.iters);
+			const auto end = BenchClock::now();
+
+			const std::chrono::duration<double, std::nano> elapsed = end - start;
+			times.emplace_back(elapsed.count() / double(b.iters));
+		}
+
+		const auto allocs = sys::memoryStats().totalCount - allocsBefore;
+
+		Result ret;
+		ret.name = Str(b.name);
+		ret.iters = b.iters;
+		ret.reps = reps;
+		ret.median = medianOf(times);
+		ret.min = *std::min_element(times.begin(), times.end());
+		ret.allocs = double(allocs) / double(b.iters * reps);
+
+		// median absolute deviation, robust against the odd preempted run
+		for(auto &&t : times) t = std::abs(t - ret.median);
+		ret.mad = medianOf(std::move(times));
+
+		return ret;
+	}
+
+	// one benchmark per line so readBaseline doesn't need a real JSON parser
+	Str toJson(const Vector<Result> &results){
+		Str out = "{\"benchmarks\":[";
+
+		for(std::size_t i = 0; i < results.size(); i++){
+			auto &&r = results[i];
+
+			formatTo<"{}\n{{\"name\":\"{}\",\"iterations\":{},\"reps\":{},\"median_ns\":{:.3f},\"mad_ns\":{:.3f},\"min_ns\":{:.3f},\"allocs_per_iter\":{:.3f}}}">(
+				out, i ? "," : "", r.name, r.iters, r.reps, r.median, r.mad, r.min, r.allocs
+			);
+		}
+
+		out += "\n]}\n";
+		return out;
+	}
+
+	bool writeFile(const char *path, const Str &data){
+		auto file = std::fopen(path, "wb");
+		if(!file) return false;
+
+		const bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+		std::fclose(file);
+		return ok;
+	}
+
+	double jsonNumber(StrView obj, StrView key){
+		const auto pos = obj.find(key);
+		if(pos == StrView::npos) return 0.0;
+
+		return std::strtod(Str(obj.substr(pos + key.size(), 32)).c_str(), nullptr);
+	}
+
+	// reads files written with --json
+	bool readBaseline(const char *path, Vector<Result> &out){
+		auto file = std::fopen(path, "rb");
+		if(!file) return false;
+
+		Str data;
+		char buf[4096];
+
+		for(std::size_t n; (n = std::fread(buf, 1, sizeof(buf), file)) > 0;){
+			data.append(buf, n);
+		}
+
+		std::fclose(file);
+
+		constexpr StrView nameKey = "\"name\":\"";
+
+		StrView rest = data;
+
+		for(auto pos = rest.find(nameKey); pos != StrView::npos; pos = rest.find(nameKey)){
+			rest.remove_prefix(pos + nameKey.size());
+
+			const auto nameEnd = rest.find('"');
+			const auto objEnd = rest.find('}');
+			if(nameEnd == StrView::npos || objEnd == StrView::npos) break;
+
+			const auto obj = rest.substr(0, objEnd);
+
+			Result r;
+			r.name = Str(rest.substr(0, nameEnd));
+			r.median = jsonNumber(obj, "\"median_ns\":");
+			r.mad = jsonNumber(obj, "\"mad_ns\":");
+			out.emplace_back(std::move(r));
+
+			rest.remove_prefix(objEnd);
+		}
+
+		return true;
+	}
+
+	void printUsage(const char *exe){
+		fmt::print(
+			stderr,
+			"usage: {} [filter] [--reps n] [--json file] [--baseline file] [--threshold fraction]\n",
+			exe
+		);
+	}
+}
+
+int main(int argc, char *argv[]){
+	Options opts;
+
+	for(int i = 1; i < argc; i++){
+		const StrView arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if(arg == "--reps" && hasValue){
+			opts.reps = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if(arg == "--json" && hasValue){
+			opts.jsonPath = argv[++i];
+		}
+		else if(arg == "--baseline" && hasValue){
+			opts.baselinePath = argv[++i];
+		}
+		else if(arg == "--threshold" && hasValue){
+			opts.threshold = std::strtod(argv[++i], nullptr);
+		}
+		else if(arg.starts_with("--") || !opts.filter.empty()){
+			printUsage(argv[0]);
+			return 1;
+		}
+		else{
+			opts.filter = arg;
+		}
+	}
+
+	Vector<Result> baseline;
+
+	if(opts.baselinePath && !readBaseline(opts.baselinePath, baseline)){
+		fmt::print(stderr, "could not read baseline '{}'\n", opts.baselinePath);
+		return 1;
+	}
+
+	// allocation counts need a GPWE_MEMORY_TRACKING build
+	constexpr bool trackAllocs = sys::memoryTracking();
+
+	fmt::print("{:<40} {:>12} {:>14} {:>10}", "benchmark", "iterations", "ns/iter", "mad");
+	if constexpr(trackAllocs) fmt::print(" {:>12}", "allocs/iter");
+	if(!baseline.empty()) fmt::print(" {:>14} {:>9}", "baseline", "change");
+	fmt::print("\n");
+
+	Vector<Result> results;
+	std::size_t numRegressed = 0;
+
+	for(auto &&b : bench::benches()){
+		if(!opts.filter.empty() && b.name.find(opts.filter) == StrView::npos){
+			continue;
+		}
+
+		auto &&r = results.emplace_back(runBench(b, opts.reps));
+
+		fmt::print("{:<40} {:>12} {:>14.2f} {:>10.2f}", r.name, r.iters, r.median, r.mad);
+		if constexpr(trackAllocs) fmt::print(" {:>12.3f}", r.allocs);
+
+		if(!baseline.empty()){
+			auto base = std::find_if(baseline.begin(), baseline.end(), [&r](auto &&x){ return x.name == r.name; });
+
+			if(base == baseline.end() || base->median <= 0.0){
+				fmt::print(" {:>14} {:>9}", "-", "new");
+			}
+			else{
+				const auto diff = r.median - base->median;
+
+				// has to be past the threshold and clear of the noise in either run
+				const bool regressed =
+					diff > base->median * opts.threshold &&
+					diff > 3.0 * std::max(r.mad, base->mad);
+
+				fmt::print(" {:>14.2f} {:>+8.1f}%", base->median, diff / base->median * 100.0);
+				if(regressed){
+					fmt::print(" REGRESSED");
+					++numRegressed;
+				}
+			}
+		}
+
+		fmt::print("\n");
+	}
+
+	if(opts.jsonPath && !writeFile(opts.jsonPath, toJson(results))){
+		fmt::print(stderr, "could not write results to '{}'\n", opts.jsonPath);
+		return 1;
+	}
+
+	if(numRegressed){
+		fmt::print(stderr, "{} benchmark(s) regressed by more than {:.0f}%\n", numRegressed, opts.threshold * 100.0);
+		return 2;
+	}
+
+	return 0;
+}
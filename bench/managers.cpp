@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <random>
+
+#include "gpwe/world.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	class BenchEntity: public world::Entity{};
+
+	// created the same way the world-simple plugin does
+	class BenchBlock: public world::Block{
+		protected:
+			UniquePtr<world::Entity> doCreateEntity() override{
+				return makeManaged<BenchEntity>();
+			}
+	};
+
+	// one entity created and destroyed while NumLive others stay alive
+	template<std::size_t NumLive>
+	void managerChurn(Nat64 iters){
+		BenchBlock block;
+
+		Vector<world::Entity*> live;
+		live.reserve(NumLive);
+
+		for(std::size_t i = 0; i < NumLive; i++){
+			live.emplace_back(block.create<world::Entity>());
+		}
+
+		for(Nat64 i = 0; i < iters; i++){
+			auto ent = block.create<world::Entity>();
+			bench::doNotOptimize(ent);
+			block.destroy(ent);
+		}
+
+		for(auto ent : live){
+			block.destroy(ent);
+		}
+	}
+
+	// a level's worth of entities created then torn down in random order
+	void managerBatch(Nat64 iters){
+		constexpr std::size_t batchSize = 1024;
+
+		static const auto order = []{
+			Vector<std::size_t> ret(batchSize);
+			for(std::size_t i = 0; i < batchSize; i++) ret[i] = i;
+			std::shuffle(ret.begin(), ret.end(), std::mt19937(1337));
+			return ret;
+		}();
+
+		BenchBlock block;
+		Vector<world::Entity*> ents(batchSize);
+
+		for(Nat64 i = 0; i < iters; i++){
+			for(auto &&ent : ents){
+				ent = block.create<world::Entity>();
+			}
+
+			for(auto idx : order){
+				block.destroy(ents[idx]);
+			}
+		}
+	}
+}
+
+GPWE_BENCH(managerChurn0, "managers/create-destroy/live-0", 200'000){ managerChurn<0>(iters); }
+GPWE_BENCH(managerChurn1k, "managers/create-destroy/live-1k", 100'000){ managerChurn<1024>(iters); }
+
+GPWE_BENCH(managerBatch1k, "managers/batch-1k", 100){ managerBatch(iters); }
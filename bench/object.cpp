@@ -0,0 +1,51 @@
+#include "gpwe/world.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	class BenchEntity: public world::Entity{};
+
+	const Str propNames[] = { "name", "position", "rotation", "scale", "aabb" };
+
+	// runtime lookup by name, as scripts and the editor do
+	void objectFind(Nat64 iters){
+		BenchEntity ent;
+
+		for(Nat64 i = 0; i < iters; i++){
+			auto prop = ent.findProperty(propNames[i % std::size(propNames)]);
+			bench::doNotOptimize(prop);
+		}
+	}
+
+	// lookup plus the checked cast to get at the value
+	void objectFindAs(Nat64 iters){
+		BenchEntity ent;
+		float acc = 0.f;
+
+		for(Nat64 i = 0; i < iters; i++){
+			auto prop = ent.findProperty(propNames[1 + (i % 3)]);
+			if(auto vec = prop->as<Vec3>()) acc += vec->x;
+		}
+
+		bench::doNotOptimize(acc);
+	}
+
+	// resolved at compile time
+	void objectStatic(Nat64 iters){
+		BenchEntity ent;
+		float acc = 0.f;
+
+		for(Nat64 i = 0; i < iters; i++){
+			bench::doNotOptimize(ent);
+			acc += ent.property<"position"_cs>().x;
+		}
+
+		bench::doNotOptimize(acc);
+	}
+}
+
+GPWE_BENCH(objectFind, "object/property/find", 5'000'000){ objectFind(iters); }
+GPWE_BENCH(objectFindAs, "object/property/find-as", 5'000'000){ objectFindAs(iters); }
+GPWE_BENCH(objectStatic, "object/property/static", 50'000'000){ objectStatic(iters); }
@@ -0,0 +1,40 @@
+#include <cmath>
+
+#include "gpwe/util/Allocator.hpp"
+#include "gpwe/Shape.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// rolling hills, cheap to build so setup stays out of the way
+	HeightMapShape makeTerrain(Nat16 res){
+		Vector<float> heights(std::size_t(res) * res);
+
+		for(std::size_t y = 0; y < res; y++){
+			for(std::size_t x = 0; x < res; x++){
+				heights[y * res + x] = std::sin(x * 0.05f) * std::cos(y * 0.05f);
+			}
+		}
+
+		return HeightMapShape(res, res, std::move(heights));
+	}
+
+	template<Nat16 Res>
+	void heightMapMesh(Nat64 iters){
+		static const auto shape = makeTerrain(Res);
+
+		for(Nat64 i = 0; i < iters; i++){
+			auto mesh = shape.generateMesh();
+			bench::doNotOptimize(mesh);
+
+			// generateMesh works in frame memory, let the arena recycle
+			sys::nextFrame();
+		}
+	}
+}
+
+GPWE_BENCH(heightMapMesh256, "shapes/heightmap-mesh/256", 20){ heightMapMesh<256>(iters); }
+GPWE_BENCH(heightMapMesh1k, "shapes/heightmap-mesh/1024", 2){ heightMapMesh<1024>(iters); }
+GPWE_BENCH(heightMapMesh4k, "shapes/heightmap-mesh/4096", 1){ heightMapMesh<4096>(iters); }
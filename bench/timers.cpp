@@ -0,0 +1,46 @@
+#include <chrono>
+
+#include "gpwe/util/TimerWheel.hpp"
+
+#include "bench.hpp"
+
+using namespace gpwe;
+using namespace std::chrono_literals;
+
+namespace {
+	// schedule then cancel, the gameplay pattern of timers that rarely fire
+	void scheduleCancel(Nat64 iters){
+		TimerWheel wheel;
+		Nat64 acc = 0;
+
+		for(Nat64 i = 0; i < iters; i++){
+			auto handle = wheel.after(std::chrono::milliseconds(1 + (i & 4095)), [&acc]{ ++acc; });
+			wheel.cancel(handle);
+		}
+
+		bench::doNotOptimize(acc);
+	}
+
+	// NumPending long timers sit in the wheel while short ones fire every tick
+	template<Nat64 NumPending>
+	void advanceFire(Nat64 iters){
+		TimerWheel wheel;
+		Nat64 acc = 0;
+
+		for(Nat64 i = 0; i < NumPending; i++){
+			wheel.after(std::chrono::hours(1) + std::chrono::milliseconds(i), [&acc]{ ++acc; });
+		}
+
+		for(Nat64 i = 0; i < iters; i++){
+			wheel.after(1ms, [&acc]{ ++acc; });
+			wheel.advance(1ms);
+		}
+
+		bench::doNotOptimize(acc);
+	}
+}
+
+GPWE_BENCH(timerScheduleCancel, "timers/schedule-cancel/wheel", 2'000'000){ scheduleCancel(iters); }
+
+GPWE_BENCH(timerAdvance0, "timers/advance/pending-0", 1'000'000){ advanceFire<0>(iters); }
+GPWE_BENCH(timerAdvance64k, "timers/advance/pending-65536", 1'000'000){ advanceFire<65536>(iters); }
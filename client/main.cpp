@@ -1,4 +1,5 @@
-﻿#include <ctime>
+﻿#include <algorithm>
+#include <ctime>
 #include <functional>
 #include <optional>
 #include <string_view>
@@ -9,6 +10,7 @@
 
 #include "gpwe/config.hpp"
 #include "gpwe/log.hpp"
+#include "gpwe/AsyncLog.hpp"
 #include "gpwe/sys.hpp"
 #include "gpwe/input.hpp"
 #include "gpwe/render.hpp"
@@ -117,9 +119,11 @@ class SDLInputManager: public input::Manager{
 	protected:
 		void pumpEvents() override{
 			while(SDL_PollEvent(&ev)){
+				sys::markDirty();
+
 				switch(ev.type){
 					case SDL_QUIT:{
-						m_sys.exitEvent();
+						pushExit();
 						break;
 					}
 
@@ -130,10 +134,7 @@ class SDLInputManager: public input::Manager{
 						auto key = sdlkToKey(ev.key.keysym.sym);
 						if(key == input::Key::count) break;
 
-						for(auto &&kb : managed<input::Keyboard>()){
-							kb->keyEvent().emit(key, ev.type == SDL_KEYDOWN);
-						}
-
+						pushKey(key, ev.type == SDL_KEYDOWN);
 						break;
 					}
 
@@ -142,12 +143,7 @@ class SDLInputManager: public input::Manager{
 						auto btn = sdlToMouseBtn(ev.button.button);
 						if(btn == input::MouseButton::count) break;
 
-						for(auto &&mouse : managed<input::Mouse>()){
-							mouse->buttonEvent().emit(btn, ev.type == SDL_MOUSEBUTTONDOWN);
-						}
-
-
-
+						pushMouseButton(btn, ev.type == SDL_MOUSEBUTTONDOWN);
 						break;
 					}
 
@@ -157,16 +153,21 @@ class SDLInputManager: public input::Manager{
 							ev.wheel.y *= -1;
 						}
 
-						for(auto &&mouse : managed<input::Mouse>()){
-							mouse->scrollEvent().emit(ev.wheel.x, ev.wheel.y);
-						}
-
+						pushMouseScroll(ev.wheel.x, ev.wheel.y);
 						break;
 					}
 
 					case SDL_MOUSEMOTION:{
-						for(auto &&mouse : managed<input::Mouse>()){
-							mouse->moveEvent().emit(ev.motion.xrel, ev.motion.yrel);
+						pushMouseMove(ev.motion.xrel, ev.motion.yrel);
+						break;
+					}
+
+					case SDL_WINDOWEVENT:{
+						if(ev.window.event == SDL_WINDOWEVENT_FOCUS_LOST){
+							setBackground(true);
+						}
+						else if(ev.window.event == SDL_WINDOWEVENT_FOCUS_GAINED){
+							setBackground(false);
 						}
 
 						break;
@@ -181,7 +182,28 @@ class SDLInputManager: public input::Manager{
 			return makeUnique<SDLMouse>(id);
 		}
 
+	private:
+		// unfocused windows drop to a low rate once input stops, unless --idle-fps is lower already
+		static constexpr float backgroundFps = 10.f;
+
+		void setBackground(bool background){
+			auto pacer = sys::framePacer();
+			if(!pacer || background == m_background) return;
+
+			m_background = background;
+
+			if(background){
+				m_focusedIdleFps = pacer->idleFps();
+				pacer->setIdleFps(m_focusedIdleFps > 0.f ? std::min(m_focusedIdleFps, backgroundFps) : backgroundFps);
+			}
+			else{
+				pacer->setIdleFps(m_focusedIdleFps);
+			}
+		}
+
 		SDL_Event ev;
+		bool m_background = false;
+		float m_focusedIdleFps = 0.f;
 };
 
 SDL_Window *gpweWin = nullptr;
@@ -234,21 +256,37 @@ int main(int argc, char *argv[]){
 		return 1;
 	}
 
-	if(SDL_GL_SetSwapInterval(-1) != 0){
-		SDL_GL_SetSwapInterval(1);
-	}
+	const bool vsync = SDL_GL_SetSwapInterval(-1) == 0 || SDL_GL_SetSwapInterval(1) == 0;
 
 	using Proc = void(*)();
 	auto loadGLFn = +[](const char *name){ return (Proc)SDL_GL_GetProcAddress(name); };
 
 	auto manager = makeUnique<sys::Manager>();
 
+	// keep console I/O off the simulation and render threads
+	manager->setLogManager(makeUnique<log::AsyncManager>());
+
 	manager->setInputManager(gpwe::makeUnique<SDLInputManager>());
 	manager->setRenderArg((void*)loadGLFn);
 	manager->setRenderSize(1280, 720);
 
+	// render a frame behind the simulation, --frame-latency 2 for two
+	manager->setFrameLatency(1);
+
 	manager->setArgs(argc, argv);
 	manager->init();
 
+	// the GL context follows the render thread
+	manager->setRenderContextFns(
+		[]{ SDL_GL_MakeCurrent(gpweWin, gpweCtx); },
+		[]{ SDL_GL_MakeCurrent(gpweWin, nullptr); }
+	);
+
+	// without vsync pace to the display rather than spinning
+	SDL_DisplayMode mode;
+	if(!vsync && SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(gpweWin), &mode) == 0){
+		manager->framePacer().setTargetFps(mode.refresh_rate > 0 ? mode.refresh_rate : 60);
+	}
+
 	return manager->exec(std::bind(SDL_GL_SwapWindow, gpweWin));
 }
@@ -0,0 +1,194 @@
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "gpwe/log.hpp"
+#include "gpwe/AsyncLog.hpp"
+#include "gpwe/sys.hpp"
+#include "gpwe/input.hpp"
+#include "gpwe/render.hpp"
+
+using namespace gpwe;
+
+namespace {
+	// no devices to read, but apps expect a keyboard and mouse to configure
+	class HeadlessInputManager: public input::Manager{
+		public:
+			HeadlessInputManager(){
+				create<input::Mouse>(0);
+				create<input::Keyboard>(0);
+			}
+	};
+
+	struct Options{
+		Nat64 frames = 0;
+		std::chrono::duration<double> duration{ 0.0 };
+		float dt = 1.f / 60.f;
+		const char *reportPath = nullptr;
+	};
+
+	volatile std::sig_atomic_t g_interrupted = 0;
+
+	std::size_t peakRssBytes() noexcept{
+#ifndef _WIN32
+		rusage usage;
+		if(getrusage(RUSAGE_SELF, &usage) == 0){
+			return std::size_t(usage.ru_maxrss) * 1024; // kilobytes on linux
+		}
+#endif
+		return 0;
+	}
+
+	Str makeReport(sys::Manager &manager, const Options &opts, Nat64 frames, double seconds){
+		using Stage = FrameStats::Stage;
+
+		auto ms = [](FrameStats::Duration dur){ return std::chrono::duration<double, std::milli>(dur).count(); };
+
+		Str out;
+		formatTo<"{{\n\"frames\":{},\n\"dt\":{:.6f},\n\"seconds\":{:.3f},\n\"fps\":{:.2f},\n\"stages\":{{">(
+			out, frames, opts.dt, seconds, seconds > 0.0 ? double(frames) / seconds : 0.0
+		);
+
+		for(std::size_t i = 0; i < FrameStats::numStages; i++){
+			const auto stage = Stage(i);
+			const auto sum = manager.frameStats().totalSummary(stage);
+
+			formatTo<"{}\n\"{}\":{{\"p50_ms\":{:.4f},\"p95_ms\":{:.4f},\"p99_ms\":{:.4f},\"max_ms\":{:.4f}}}">(
+				out, i ? "," : "", FrameStats::stageName(stage), ms(sum.p50), ms(sum.p95), ms(sum.p99), ms(sum.max)
+			);
+		}
+
+		const auto counters = manager.renderManager()->counters();
+
+		formatTo<"\n}},\n\"render\":{{\"frames\":{},\"draws\":{},\"instances\":{},\"bytes\":{}}}">(
+			out, counters.frames, counters.draws, counters.instances, counters.bytes
+		);
+
+		formatTo<",\n\"memory\":{{\"peak_rss_bytes\":{}">(out, peakRssBytes());
+
+		// per-manager numbers need a GPWE_MEMORY_TRACKING build
+		if constexpr(sys::memoryTracking()){
+			formatTo<",\"tracked_peak_bytes\":{}">(out, sys::memoryStats().peakBytes);
+
+			constexpr std::pair<StrView, ManagerKind> kinds[] = {
+				{ "input", ManagerKind::input },
+				{ "app", ManagerKind::app },
+				{ "physics", ManagerKind::physics },
+				{ "render", ManagerKind::render },
+				{ "world", ManagerKind::world }
+			};
+
+			for(auto &&[name, kind] : kinds){
+				formatTo<",\"{}_peak_bytes\":{}">(out, name, sys::memoryStats(kind).peakBytes);
+			}
+		}
+
+		out += "}\n}\n";
+		return out;
+	}
+
+	void printUsage(const char *exe){
+		std::fprintf(
+			stderr,
+			"usage: %s [--frames n] [--seconds s] [--dt s] [--report file] [engine options]\n",
+			exe
+		);
+	}
+}
+
+int main(int argc, char *argv[]){
+	Options opts;
+
+	// anything not recognised here is left for sys::Manager, e.g. --replay-input
+	for(int i = 1; i < argc; i++){
+		const StrView arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if(arg == "--frames" && hasValue){
+			opts.frames = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if(arg == "--seconds" && hasValue){
+			opts.duration = std::chrono::duration<double>(std::strtod(argv[++i], nullptr));
+		}
+		else if(arg == "--dt" && hasValue){
+			opts.dt = std::strtof(argv[++i], nullptr);
+		}
+		else if(arg == "--report" && hasValue){
+			opts.reportPath = argv[++i];
+		}
+		else if(arg == "--help"){
+			printUsage(argv[0]);
+			return 0;
+		}
+	}
+
+	if(opts.dt <= 0.f){
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	if(!opts.frames && opts.duration.count() <= 0.0){
+		opts.frames = 1000;
+	}
+
+	std::signal(SIGINT, [](int){ g_interrupted = 1; });
+
+	auto manager = makeUnique<sys::Manager>();
+
+	manager->setLogManager(makeUnique<log::AsyncManager>());
+
+	// no window, so nothing to pump; --replay-input still feeds recorded sessions
+	manager->setInputManager(makeUnique<HeadlessInputManager>());
+
+	// rendering comes from the embedded renderer-null plugin
+	manager->setRenderSize(1280, 720);
+
+	manager->setArgs(argc, argv);
+	manager->init();
+
+	using Clock = std::chrono::steady_clock;
+
+	const auto start = Clock::now();
+	Nat64 frames = 0;
+
+	while(manager->running() && !g_interrupted){
+		if(opts.frames && frames >= opts.frames) break;
+		if(opts.duration.count() > 0.0 && Clock::now() - start >= opts.duration) break;
+
+		manager->update(opts.dt);
+		++frames;
+	}
+
+	const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+	const auto report = makeReport(*manager.get(), opts, frames, elapsed.count());
+
+	// flushes the log, so it can't end up in the middle of the report
+	manager.reset();
+
+	if(!opts.reportPath){
+		std::fwrite(report.data(), 1, report.size(), stdout);
+		return 0;
+	}
+
+	auto file = std::fopen(opts.reportPath, "wb");
+	if(!file){
+		log::errorLn("Could not open '{}' to write the report", opts.reportPath);
+		return 1;
+	}
+
+	const bool ok = std::fwrite(report.data(), 1, report.size(), file) == report.size();
+	std::fclose(file);
+
+	if(!ok){
+		log::errorLn("Could not write the report to '{}'", opts.reportPath);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#ifndef GPWE_ASYNCLOG_HPP
+#define GPWE_ASYNCLOG_HPP 1
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+
+#include "util/Thread.hpp"
+#include "log.hpp"
+
+namespace gpwe::log{
+	enum class OverflowPolicy{
+		drop, // lose the message and count it, logging never waits
+		block // wait for the writer to make room
+	};
+
+	struct AsyncConfig{
+		std::size_t capacity = 4096; // messages in flight, rounded up to a power of two
+		OverflowPolicy overflow = OverflowPolicy::drop;
+
+		Str path; // empty for stdout and stderr
+		std::size_t maxFileSize = 16 * 1024 * 1024; // rotate once a file grows past this, 0 never rotates
+		Nat32 maxFiles = 4; // rotated files kept as path.1 up to path.N
+
+		std::chrono::milliseconds flushInterval{ 100 };
+		std::size_t historySize = Manager::defaultHistorySize;
+	};
+
+	/**
+	 * @brief Log that hands messages to a background writer thread.
+	 * Messages are copied into a fixed ring of cache line aligned slots, so the
+	 * logging thread never touches I/O. The writer wakes every flushInterval,
+	 * when the ring is half full or on an error, and writes everything pending
+	 * in one go. Messages longer than a slot are copied to the heap.
+	 */
+	class AsyncManager: public Manager{
+		public:
+			explicit AsyncManager(AsyncConfig config = {});
+
+			~AsyncManager();
+
+			const AsyncConfig &config() const noexcept{ return m_config; }
+
+			// wait until everything logged before the call has been written
+			void flush();
+
+			// messages lost to a full ring under OverflowPolicy::drop
+			Nat64 numDropped() const noexcept{ return m_numDropped.load(std::memory_order_relaxed); }
+
+		protected:
+			void submit(Kind kind, StrView str) override;
+
+		private:
+			static constexpr std::size_t slotSize = 256;
+
+			struct Slot{
+				std::atomic<std::size_t> seq;
+				Entry::TimePoint time;
+				char *heap;
+				Nat32 len;
+				Kind kind;
+				char text[slotSize - sizeof(std::atomic<std::size_t>) - sizeof(Entry::TimePoint) - sizeof(char*) - sizeof(Nat32) - sizeof(Kind)];
+			};
+
+			static_assert(sizeof(Slot) == slotSize);
+
+			void wakeWriter();
+			void writerFn();
+			std::size_t writePending();
+			void writeOut(std::FILE *fd, Str &buf);
+			bool openFile();
+			void rotate();
+
+			AsyncConfig m_config;
+			Slot *m_slots;
+			std::size_t m_mask;
+
+			std::FILE *m_file = nullptr;
+			std::size_t m_fileSize = 0;
+			Str m_outBuf, m_errBuf;
+			Nat64 m_numDroppedReported = 0;
+
+			std::mutex m_mut;
+			std::condition_variable m_cv;
+			std::atomic_bool m_sleeping = false, m_wake = false, m_stop = false;
+
+			// padded rather than aligned, managers are heap allocated
+			char m_pad0[64];
+			std::atomic<std::size_t> m_tail = 0;
+			std::atomic<Nat64> m_numDropped = 0;
+			char m_pad1[64 - sizeof(std::atomic<std::size_t>) - sizeof(std::atomic<Nat64>)];
+			std::size_t m_head = 0;
+			std::atomic<std::size_t> m_written = 0;
+
+			UniquePtr<Thread> m_writer;
+	};
+}
+
+#endif // !GPWE_ASYNCLOG_HPP
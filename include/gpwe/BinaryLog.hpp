@@ -0,0 +1,255 @@
+#ifndef GPWE_BINARYLOG_HPP
+#define GPWE_BINARYLOG_HPP 1
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#include "util/meta.hpp"
+#include "util/Thread.hpp"
+#include "log.hpp"
+
+namespace gpwe::log{
+	// tags written before every argument, so records decode without the call site
+	enum class ArgType: Nat8{
+		int_, uint, float_, bool_, char_, str, ptr
+	};
+
+	// record header, followed by numArgs tagged arguments; records are 8 byte aligned
+	struct BinaryRecord{
+		Nat16 size; // whole record including padding, 0 marks a wrap to the start of a buffer
+		Nat8 kind;
+		Nat8 numArgs;
+		Nat32 site;
+		Nat64 time; // nanoseconds since the system clock epoch
+	};
+
+	static_assert(sizeof(BinaryRecord) == 16);
+
+	namespace detail{
+		struct BinaryBuffer;
+
+		constexpr std::size_t maxBinaryStrLen = 1024;
+
+		Nat32 registerBinarySite(const char *fmt);
+
+		// nullptr when no BinaryLog is running
+		BinaryBuffer *binaryBuffer();
+
+		std::byte *binaryReserve(BinaryBuffer *buf, std::size_t size) noexcept;
+		void binaryCommit(BinaryBuffer *buf, std::size_t size) noexcept;
+
+		template<meta::CStr Fmt>
+		struct BinarySite{
+			static Nat32 id(){
+				static const Nat32 ret = registerBinarySite(Fmt.str);
+				return ret;
+			}
+		};
+
+		// the synchronous fallback formats what the writer would decode
+		template<typename T>
+		inline decltype(auto) binaryFallbackArg(const T &arg) noexcept{
+			if constexpr(std::is_enum_v<T>) return Int64(arg);
+			else return (arg);
+		}
+
+		template<typename T>
+		constexpr std::size_t binaryArgSize(const T &arg) noexcept{
+			using U = std::remove_cvref_t<T>;
+
+			if constexpr(std::is_convertible_v<const T&, StrView> && !std::is_same_v<U, std::nullptr_t>){
+				return 1 + sizeof(Nat32) + std::min(StrView(arg).size(), maxBinaryStrLen);
+			}
+			else{
+				return 1 + sizeof(Nat64);
+			}
+		}
+
+		template<typename T>
+		inline std::byte *writeBinaryArg(std::byte *out, const T &arg) noexcept{
+			using U = std::remove_cvref_t<T>;
+
+			auto put = [&out](ArgType type, const void *data, std::size_t n){
+				*out++ = std::byte(type);
+				std::memcpy(out, data, n);
+				out += n;
+			};
+
+			if constexpr(std::is_same_v<U, bool>){
+				const Nat64 val = arg;
+				put(ArgType::bool_, &val, sizeof(val));
+			}
+			else if constexpr(std::is_same_v<U, char>){
+				const Nat64 val = Nat8(arg);
+				put(ArgType::char_, &val, sizeof(val));
+			}
+			else if constexpr(std::is_enum_v<U>){
+				const Int64 val = Int64(arg);
+				put(ArgType::int_, &val, sizeof(val));
+			}
+			else if constexpr(std::is_integral_v<U> && std::is_signed_v<U>){
+				const Int64 val = arg;
+				put(ArgType::int_, &val, sizeof(val));
+			}
+			else if constexpr(std::is_integral_v<U>){
+				const Nat64 val = arg;
+				put(ArgType::uint, &val, sizeof(val));
+			}
+			else if constexpr(std::is_floating_point_v<U>){
+				const double val = arg;
+				put(ArgType::float_, &val, sizeof(val));
+			}
+			else if constexpr(std::is_convertible_v<const T&, StrView> && !std::is_same_v<U, std::nullptr_t>){
+				const StrView str(arg);
+				const Nat32 len = Nat32(std::min(str.size(), maxBinaryStrLen));
+				put(ArgType::str, &len, sizeof(len));
+				std::memcpy(out, str.data(), len);
+				out += len;
+			}
+			else if constexpr(std::is_pointer_v<U> || std::is_same_v<U, std::nullptr_t>){
+				const Nat64 val = reinterpret_cast<std::uintptr_t>(arg);
+				put(ArgType::ptr, &val, sizeof(val));
+			}
+			else{
+				static_assert(sizeof(U) == 0, "Type can't be logged in binary, format it first");
+			}
+
+			return out;
+		}
+	}
+
+	/**
+	 * @brief Log a line without formatting it on this thread.
+	 * The format string is registered once per call site; each call only copies
+	 * the raw arguments into a per-thread buffer for the BinaryLog writer.
+	 * Without a running BinaryLog this formats and logs as usual.
+	 */
+	template<meta::CStr Fmt, typename ... Args>
+	inline void binLn(Kind kind, const Args &... args){
+		auto buf = detail::binaryBuffer();
+
+		if(!buf){
+			outLn(kind, Fmt.str, detail::binaryFallbackArg(args)...);
+			return;
+		}
+
+		static_assert(sizeof...(Args) < 256);
+		static_assert(gpwe::detail::checkFormatArgs<Fmt, Args...>());
+
+		const auto size = (sizeof(BinaryRecord) + ... + detail::binaryArgSize(args));
+		const auto padded = (size + 7) & ~std::size_t(7);
+
+		auto out = detail::binaryReserve(buf, padded);
+		if(!out) return;
+
+		const BinaryRecord header{
+			Nat16(padded), Nat8(kind), Nat8(sizeof...(Args)), detail::BinarySite<Fmt>::id(),
+			Nat64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count())
+		};
+
+		std::memcpy(out, &header, sizeof(header));
+
+		auto argOut = out + sizeof(header);
+		((argOut = detail::writeBinaryArg(argOut, args)), ...);
+
+		detail::binaryCommit(buf, padded);
+	}
+
+	template<meta::CStr Fmt, typename ... Args>
+	inline void binInfoLn(const Args &... args){ binLn<Fmt>(Kind::info, args...); }
+
+	template<meta::CStr Fmt, typename ... Args>
+	inline void binWarnLn(const Args &... args){ binLn<Fmt>(Kind::warning, args...); }
+
+	template<meta::CStr Fmt, typename ... Args>
+	inline void binErrorLn(const Args &... args){ binLn<Fmt>(Kind::error, args...); }
+
+	// format a whole record into out, false if its arguments are malformed or don't match fmt
+	bool decodeBinaryRecord(Str &out, const char *fmt, const BinaryRecord *record);
+
+	struct BinaryConfig{
+		Str path; // empty to format on the writer thread and pass lines to the log manager
+		std::size_t bufferSize = 64 * 1024; // per thread, rounded up to a power of two
+		std::chrono::milliseconds flushInterval{ 50 };
+		Manager *logManager = nullptr; // sys::logManager() when the BinaryLog is made, must outlive it
+	};
+
+	/**
+	 * @brief Collects binary log records from every thread.
+	 * Only one may run at a time. Records are merged by time on a writer
+	 * thread, then either formatted into the log manager or written as is to
+	 * a file for gpwe-logdecode. A full thread buffer drops records.
+	 */
+	class BinaryLog{
+		public:
+			static constexpr char fileMagic[8] = { 'G', 'P', 'W', 'E', 'B', 'L', 'O', 'G' };
+			static constexpr Nat32 fileVersion = 1;
+
+			// chunks in a binary log file, each starts with one of these bytes
+			enum class Chunk: Nat8{
+				site = 1, // Nat32 id, Nat32 length, format string
+				record = 2 // a BinaryRecord and its arguments
+			};
+
+			explicit BinaryLog(BinaryConfig config = {});
+
+			BinaryLog(const BinaryLog&) = delete;
+
+			~BinaryLog();
+
+			BinaryLog &operator=(const BinaryLog&) = delete;
+
+			const BinaryConfig &config() const noexcept{ return m_config; }
+
+			// wait until everything logged before the call has been written
+			void flush();
+
+			// records lost to full thread buffers
+			Nat64 numDropped() const noexcept{ return m_numDropped.load(std::memory_order_relaxed); }
+
+		private:
+			void wakeWriter() noexcept;
+			void writerFn();
+			bool writePending();
+			void writeRecord(const BinaryRecord *record);
+			void reapBuffers();
+
+			detail::BinaryBuffer *addBuffer();
+
+			BinaryConfig m_config;
+			Manager *m_logManager; // the writer thread has no sys manager to look it up through
+			std::FILE *m_file = nullptr;
+			Nat32 m_numSitesWritten = 0;
+
+			Nat64 m_gen;
+			std::mutex m_buffersMut;
+			Vector<detail::BinaryBuffer*> m_buffers;
+			std::atomic<Nat64> m_numDropped = 0;
+			Nat64 m_numDroppedReported = 0;
+
+			// writer thread only
+			Vector<detail::BinaryBuffer*> m_snapshot;
+			Vector<std::size_t> m_tails;
+			Vector<const BinaryRecord*> m_pending;
+			Vector<const char*> m_sites;
+			Str m_line;
+
+			std::mutex m_mut;
+			std::condition_variable m_cv;
+			bool m_stop = false;
+			std::atomic_bool m_sleeping = false, m_wake = false;
+			Nat64 m_flushRequests = 0, m_flushesDone = 0;
+
+			UniquePtr<Thread> m_writer;
+
+			friend detail::BinaryBuffer *detail::binaryBuffer();
+			friend std::byte *detail::binaryReserve(detail::BinaryBuffer*, std::size_t) noexcept;
+			friend void detail::binaryCommit(detail::BinaryBuffer*, std::size_t) noexcept;
+	};
+}
+
+#endif // !GPWE_BINARYLOG_HPP
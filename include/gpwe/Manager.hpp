@@ -9,6 +9,7 @@
 #include "util/Object.hpp"
 #include "util/algo.hpp"
 #include "util/List.hpp"
+#include "util/Pool.hpp"
 #include "util/Str.hpp"
 #include "Version.hpp"
 
@@ -57,6 +58,14 @@ namespace gpwe{
 		count
 	};
 
+	/**
+	 * @brief Whether managers make objects of type T from the shared Pool<T>.
+	 * Specialize it for a managed base type to pool everything deriving from it,
+	 * or for a single concrete type.
+	 */
+	template<typename T>
+	inline constexpr bool poolManaged = false;
+
 	/**
 	 * @brief Base class of the real meat and two veg manager.
 	 */
@@ -134,6 +143,12 @@ namespace gpwe{
 				return this->ManagerStorage<T>::ptrs();
 			}
 
+			// true if objects of type T come from Pool<T>, see poolManaged
+			template<typename T>
+			static constexpr bool isPooled() noexcept{
+				return poolManaged<T> || ((std::is_base_of_v<Ts, T> && poolManaged<Ts>) || ...);
+			}
+
 			template<typename T>
 			static constexpr bool hasManaged(){
 				constexpr auto tRep = meta::repeat(meta::type<T>, meta::value<sizeof...(Ts)>);
@@ -147,6 +162,21 @@ namespace gpwe{
 				);
 			}
 
+		protected:
+			/**
+			 * @brief Make an object the way doCreate functions should.
+			 * From the shared Pool<T> if isPooled<T>(), otherwise like makeUnique.
+			 */
+			template<typename T, typename ... Args>
+			static UniquePtr<T> makeManaged(Args &&... args){
+				if constexpr(isPooled<T>()){
+					return makePooled<T>(std::forward<Args>(args)...);
+				}
+				else{
+					return makeUnique<T>(std::forward<Args>(args)...);
+				}
+			}
+
 		private:
 			template<typename T>
 			T *insertUnique(UniquePtr<T> ptr){
@@ -11,6 +11,9 @@ namespace gpwe::app{
 	{
 		public:
 			virtual void update(float dt) = 0;
+
+			// called once per fixed simulation step, before physics
+			virtual void fixedUpdate(float dt){}
 	};
 }
 
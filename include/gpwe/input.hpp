@@ -1,34 +1,45 @@
 #ifndef GPWE_INPUT_HPP
 #define GPWE_INPUT_HPP 1
 
+#include <atomic>
+#include <bitset>
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
 #include <map>
 
 #include "util/Event.hpp"
+#include "util/SpscRing.hpp"
+#include "util/Vector.hpp"
 #include "Manager.hpp"
 
 namespace gpwe::input{
 	class System: public Object<System>{
 		public:
-			using ExitEventFn = Fn<void()>;
-
-			using ExitEventIter = List<ExitEventFn>::iterator;
+			using ExitEvent = Event<>;
 
 			template<typename Fn>
-			ExitEventIter onExitEvent(Fn &&fn){
-				return m_exitFns.emplace(m_exitFns.end(), std::forward<Fn>(fn));
+			ExitEvent::Handle onExitEvent(Fn &&fn){
+				return m_exitEvent.addFn(std::forward<Fn>(fn));
+			}
+
+			bool removeExitEventFn(ExitEvent::Handle handle){
+				return m_exitEvent.removeFn(handle);
 			}
 
 			void exitEvent(){
-				for(auto &&fn : m_exitFns){
-					fn();
-				}
+				m_exitEvent.emit();
+			}
+
+			// from any thread, listeners run on the next input update
+			void postExitEvent(){
+				m_exitEvent.post();
 			}
 
 		private:
 			System() noexcept{}
 
-			List<ExitEventFn> m_exitFns;
+			ExitEvent m_exitEvent;
 
 			friend class Manager;
 	};
@@ -66,6 +77,52 @@ namespace gpwe::input{
 		count
 	};
 
+	enum class EventKind: std::uint8_t{
+		key, mouseButton, mouseMove, mouseScroll, exit
+	};
+
+	/**
+	 * @brief A single input event as pushed by the platform layer.
+	 * Plain data so it can go through the event ring and into recordings as is.
+	 */
+	struct RawEvent{
+		Nat64 time; // nanoseconds since the manager was created
+		EventKind kind;
+		std::uint8_t device;
+		Nat16 code; // Key or MouseButton
+		Int32 x, y; // pressed state for buttons, relative motion otherwise
+	};
+
+	static_assert(std::is_trivially_copyable_v<RawEvent>);
+
+	/**
+	 * @brief Input state at the end of one input update.
+	 * Published once per frame and never modified afterwards.
+	 */
+	struct Snapshot{
+		using KeyBits = std::bitset<(std::size_t)Key::count>;
+		using ButtonBits = std::bitset<(std::size_t)MouseButton::count>;
+
+		Nat64 frame = 0;
+		Nat64 time = 0;
+
+		KeyBits keys, keysPressed, keysReleased;
+		ButtonBits buttons, buttonsPressed, buttonsReleased;
+
+		Int32 mouseDx = 0, mouseDy = 0;
+		Int32 scrollX = 0, scrollY = 0;
+
+		Nat32 numEvents = 0;
+
+		bool keyDown(Key key) const noexcept{ return keys[(std::size_t)key]; }
+		bool keyPressed(Key key) const noexcept{ return keysPressed[(std::size_t)key]; }
+		bool keyReleased(Key key) const noexcept{ return keysReleased[(std::size_t)key]; }
+
+		bool buttonDown(MouseButton btn) const noexcept{ return buttons[(std::size_t)btn]; }
+		bool buttonPressed(MouseButton btn) const noexcept{ return buttonsPressed[(std::size_t)btn]; }
+		bool buttonReleased(MouseButton btn) const noexcept{ return buttonsReleased[(std::size_t)btn]; }
+	};
+
 	class Keyboard;
 	class Mouse;
 	class Gamepad;
@@ -76,17 +133,19 @@ namespace gpwe::input{
 
 			using PumpEventIt = List<PumpEventFn>::iterator;
 
-			virtual ~Manager() = default;
+			static constexpr std::size_t numSnapshots = 4;
 
-			void update(float dt) override{
-				(void)dt;
+			Manager();
 
-				for(auto &&fn : m_pumpFns){
-					fn();
-				}
+			virtual ~Manager();
 
-				pumpEvents();
-			}
+			/**
+			 * @brief Pump platform events, then apply everything queued this frame.
+			 * Events update the next snapshot and go out through the device events
+			 * in the order they were pushed, followed by anything posted to the
+			 * device and exit events from other threads.
+			 */
+			void update(float dt) override;
 
 			template<typename Fn>
 			PumpEventIt onPumpEvents(Fn &&fn){
@@ -95,12 +154,70 @@ namespace gpwe::input{
 
 			System *system() noexcept{ return &m_sys; }
 
+			/**
+			 * @brief Queue an event for the next update, stamped with the current time.
+			 * Lock-free; only one thread may push at a time.
+			 */
+			bool pushEvent(RawEvent ev) noexcept;
+
+			bool pushKey(Key key, bool pressed, std::uint8_t device = 0) noexcept{
+				return pushEvent({ 0, EventKind::key, device, Nat16(key), pressed, 0 });
+			}
+
+			bool pushMouseButton(MouseButton btn, bool pressed, std::uint8_t device = 0) noexcept{
+				return pushEvent({ 0, EventKind::mouseButton, device, Nat16(btn), pressed, 0 });
+			}
+
+			bool pushMouseMove(Int32 xrel, Int32 yrel, std::uint8_t device = 0) noexcept{
+				return pushEvent({ 0, EventKind::mouseMove, device, 0, xrel, yrel });
+			}
+
+			bool pushMouseScroll(Int32 xrel, Int32 yrel, std::uint8_t device = 0) noexcept{
+				return pushEvent({ 0, EventKind::mouseScroll, device, 0, xrel, yrel });
+			}
+
+			bool pushExit() noexcept{
+				return pushEvent({ 0, EventKind::exit, 0, 0, 0, 0 });
+			}
+
+			/**
+			 * @brief Latest published snapshot, safe to read from any thread.
+			 * The reference stays valid for numSnapshots - 1 more updates.
+			 */
+			const Snapshot &snapshot() const noexcept{
+				return m_snapshots[m_latest.load(std::memory_order_acquire)];
+			}
+
+			/**
+			 * @brief Write every event and frame time from now on to \p path.
+			 * Returns false if the file couldn't be opened.
+			 */
+			bool startRecording(StrView path);
+			void stopRecording();
+			bool recording() const noexcept{ return m_recordFile != nullptr; }
+
+			/**
+			 * @brief Feed events recorded to \p path instead of live ones.
+			 * One recorded frame is replayed per update, live input is ignored
+			 * apart from exit requests.
+			 */
+			bool startReplay(StrView path);
+			void stopReplay();
+			bool replaying() const noexcept{ return m_replayFile != nullptr; }
+
+			// frame time recorded for the frame just replayed
+			float replayDt() const noexcept{ return m_replayDt; }
+
 		protected:
 			virtual void pumpEvents(){}
 
-			virtual UniquePtr<Keyboard> doCreateKeyboard(std::uint32_t id){ return makeUnique<Keyboard>(id); }
-			virtual UniquePtr<Mouse> doCreateMouse(std::uint32_t id){ return makeUnique<Mouse>(id); }
-			virtual UniquePtr<Gamepad> doCreateGamepad(std::uint32_t id){ return makeUnique<Gamepad>(id); }
+			void dispatch(const RawEvent &ev);
+			bool readReplayFrame();
+			void writeRecordFrame(Nat64 frame, float dt);
+
+			virtual UniquePtr<Keyboard> doCreateKeyboard(std::uint32_t id){ return makeManaged<Keyboard>(id); }
+			virtual UniquePtr<Mouse> doCreateMouse(std::uint32_t id){ return makeManaged<Mouse>(id); }
+			virtual UniquePtr<Gamepad> doCreateGamepad(std::uint32_t id){ return makeManaged<Gamepad>(id); }
 
 			template<typename T>
 			static T *getFromList(List<T> &l, std::uint32_t idx){
@@ -119,6 +236,18 @@ namespace gpwe::input{
 
 			List<PumpEventFn> m_pumpFns;
 
+			std::chrono::steady_clock::time_point m_start;
+			SpscRing<RawEvent> m_events;
+			std::atomic<Nat64> m_numDropped = 0;
+			Nat64 m_numDroppedSeen = 0;
+
+			Vector<RawEvent> m_frameEvents;
+			Snapshot m_snapshots[numSnapshots];
+			std::atomic<Nat32> m_latest = 0;
+
+			std::FILE *m_recordFile = nullptr, *m_replayFile = nullptr;
+			float m_replayDt = 0.f;
+
 			friend class Keyboard;
 			friend class Mouse;
 			friend class Gamepad;
@@ -3,12 +3,15 @@
 
 #include <functional>
 #include <chrono>
+#include <mutex>
 
 #include "fmt/core.h"
 
 #include "util/List.hpp"
+#include "util/Vector.hpp"
 #include "util/Str.hpp"
 #include "Manager.hpp"
+#include "memory.hpp"
 
 namespace gpwe::log{
 	class Manager;
@@ -19,9 +22,18 @@ namespace gpwe{
 
 	template<typename String, typename ... Args>
 	inline Str format(String &&str, Args &&... args){
-		Str ret;
-		fmt::format_to(std::back_inserter(ret), std::forward<String>(str), std::forward<Args>(args)...);
-		return ret;
+		detail::FormatBuffer buf;
+		fmt::format_to(std::back_inserter(buf), std::forward<String>(str), std::forward<Args>(args)...);
+		return Str(buf.data(), buf.size());
+	}
+
+	// same as format, but the result only lives until the end of next frame
+	template<typename String, typename ... Args>
+	inline FrameStr frameFormat(String &&str, Args &&... args){
+		// growing a frame string char by char would leave every old copy in the arena
+		detail::FormatBuffer buf;
+		fmt::format_to(std::back_inserter(buf), std::forward<String>(str), std::forward<Args>(args)...);
+		return FrameStr(buf.data(), buf.size());
 	}
 }
 
@@ -42,19 +54,33 @@ namespace gpwe::log{
 		Str str;
 	};
 
+	/**
+	 * @brief Synchronous log, writes on the calling thread.
+	 * Keeps the last historySize() entries for entries(); derived managers
+	 * change where messages go by overriding submit or doLog.
+	 */
 	class Manager: public gpwe::Manager<Manager, ManagerKind::log>{
 		public:
 			using Clock = std::chrono::system_clock;
 
+			static constexpr std::size_t defaultHistorySize = 1024;
+
+			virtual ~Manager() = default;
+
+			// lines are formatted on the stack, only ones past inline_buffer_size touch the heap
 			template<typename String, typename ... Args>
 			void log(Kind kind, String &&str, Args &&... args){
-				auto &&entry = m_entries.emplace_back(Entry{ Clock::now(), kind, format(std::forward<String>(str), std::forward<Args>(args)...) });
-				return doLog(&entry);
+				detail::FormatBuffer buf;
+				fmt::format_to(std::back_inserter(buf), std::forward<String>(str), std::forward<Args>(args)...);
+				submit(kind, StrView(buf.data(), buf.size()));
 			}
 
 			template<typename String, typename ... Args>
 			void logLn(Kind kind, String &&str, Args &&... args){
-				return log(kind, "{}\n", format(std::forward<String>(str), std::forward<Args>(args)...));
+				detail::FormatBuffer buf;
+				fmt::format_to(std::back_inserter(buf), std::forward<String>(str), std::forward<Args>(args)...);
+				buf.push_back('\n');
+				submit(kind, StrView(buf.data(), buf.size()));
 			}
 
 			template<typename String, typename ... Args>
@@ -87,9 +113,32 @@ namespace gpwe::log{
 				return logLn(Kind::error, std::forward<String>(str), std::forward<Args>(args)...);
 			}
 
-			const List<Entry> &entries() const noexcept{ return m_entries; }
+			// copy of the retained history, oldest first
+			Vector<Entry> entries() const{
+				std::lock_guard lock(m_historyMut);
+				return Vector<Entry>(m_entries.begin(), m_entries.end());
+			}
+
+			// 0 keeps no history
+			void setHistorySize(std::size_t n){
+				std::lock_guard lock(m_historyMut);
+				m_historySize = n;
+
+				while(m_entries.size() > m_historySize){
+					m_entries.pop_front();
+				}
+			}
+
+			std::size_t historySize() const noexcept{ return m_historySize; }
 
 		protected:
+			// every formatted message goes through here, on the thread that logged it
+			virtual void submit(Kind kind, StrView str){
+				const Entry entry{ Clock::now(), kind, Str(str) };
+				doLog(&entry);
+				remember(entry.time, kind, str);
+			}
+
 			virtual void doLog(const Entry *entry){
 				std::FILE *fd = stdout;
 
@@ -102,13 +151,28 @@ namespace gpwe::log{
 					default: break;
 				}
 
-
-				std::fprintf(fd, "%s", entry->str.c_str());
+				std::fwrite(entry->str.data(), 1, entry->str.size(), fd);
 				std::fflush(fd);
 			}
 
+			void remember(Entry::TimePoint time, Kind kind, StrView str){
+				// history is owned by the log, whoever happened to write it
+				sys::MemoryTagScope tag(ManagerKind::log);
+				std::lock_guard lock(m_historyMut);
+
+				if(!m_historySize) return;
+
+				if(m_entries.size() >= m_historySize){
+					m_entries.pop_front();
+				}
+
+				m_entries.emplace_back(Entry{ time, kind, Str(str) });
+			}
+
 		private:
+			mutable std::mutex m_historyMut;
 			List<Entry> m_entries;
+			std::size_t m_historySize = defaultHistorySize;
 	};
 
 	inline Manager *manager() noexcept{ return sys::logManager(); }
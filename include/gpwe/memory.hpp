@@ -0,0 +1,69 @@
+#ifndef GPWE_MEMORY_HPP
+#define GPWE_MEMORY_HPP 1
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gpwe/config.hpp"
+
+#include "Manager.hpp"
+
+/**
+ * Allocation tracking
+ *
+ * Only active when built with GPWE_MEMORY_TRACKING, otherwise every query
+ * returns zeroes and tag scopes compile to nothing.
+ */
+
+namespace gpwe::sys{
+	struct MemoryStats{
+		std::size_t liveBytes = 0;
+		std::size_t liveCount = 0;
+		std::size_t peakBytes = 0;
+		std::uint64_t totalCount = 0;
+	};
+
+	constexpr bool memoryTracking() noexcept{ return GPWE_MEMORY_TRACKING; }
+
+	/**
+	 * @brief Stats for allocations made while \p kind was the current tag.
+	 * Passing ManagerKind::count gives the untagged allocations. Pooled blocks
+	 * count against the tag their pool chunk was made under.
+	 */
+	MemoryStats memoryStats(ManagerKind kind) noexcept;
+
+	// stats for every allocation, tagged or not
+	MemoryStats memoryStats() noexcept;
+
+	// number of allocations made during the last complete frame
+	std::uint64_t frameAllocCount() noexcept;
+
+	// tag used for allocations on the calling thread, ManagerKind::count if untagged
+	ManagerKind memoryTag() noexcept;
+	void setMemoryTag(ManagerKind kind) noexcept;
+
+	class MemoryTagScope{
+		public:
+#if GPWE_MEMORY_TRACKING
+			explicit MemoryTagScope(ManagerKind kind) noexcept
+				: m_prev(memoryTag())
+			{
+				setMemoryTag(kind);
+			}
+
+			~MemoryTagScope(){ setMemoryTag(m_prev); }
+#else
+			explicit MemoryTagScope(ManagerKind) noexcept{}
+#endif
+
+			MemoryTagScope(const MemoryTagScope&) = delete;
+			MemoryTagScope &operator=(const MemoryTagScope&) = delete;
+
+#if GPWE_MEMORY_TRACKING
+		private:
+			ManagerKind m_prev;
+#endif
+	};
+}
+
+#endif // !GPWE_MEMORY_HPP
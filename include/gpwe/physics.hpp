@@ -58,6 +58,11 @@ namespace gpwe::physics{
 	};
 }
 
+namespace gpwe{
+	template<> inline constexpr bool poolManaged<physics::BodyShape> = true;
+	template<> inline constexpr bool poolManaged<physics::Body> = true;
+}
+
 #define GPWE_PHYSICS_PLUGIN(type, name, author, major, minor, patch)\
 	GPWE_PLUGIN(physics, type, name, author, major, minor, patch)
 
@@ -2,12 +2,17 @@
 #define GPWE_RENDER_HPP 1
 
 #include "util/Vector.hpp"
+#include "util/Fn.hpp"
 
 #include "Version.hpp"
 #include "Manager.hpp"
 #include "Shape.hpp"
 #include "Camera.hpp"
 
+namespace gpwe::sys{
+	bool renderCall(FnRef<void()> f);
+}
+
 namespace gpwe::render{
 	class Texture;
 	class Group;
@@ -113,6 +118,36 @@ namespace gpwe::render{
 			std::uint32_t m_len;
 	};
 
+	// snapshot slots a renderer may need to keep copies for, at least sys::Manager::maxFrameLatency
+	inline constexpr std::uint32_t maxFrameSnapshots = 2;
+
+	/**
+	 * @brief Everything the renderer reads of a simulated frame.
+	 * Filled on the simulation thread, then read-only until presented.
+	 */
+	struct FrameSnapshot{
+		std::uint64_t frame;
+
+		// which of the frameLatency snapshot buffers this is, for renderers keeping their own copies
+		std::uint32_t slot;
+
+		Camera camera;
+
+		// SimClock::alpha when the snapshot was taken, for interpolating between steps
+		float alpha;
+	};
+
+	/**
+	 * @brief Work submitted by present since the renderer started.
+	 * Backends that don't count leave everything at 0.
+	 */
+	struct Counters{
+		std::uint64_t frames = 0;
+		std::uint64_t draws = 0;
+		std::uint64_t instances = 0;
+		std::uint64_t bytes = 0; // vertex, index and instance data read by the draws
+	};
+
 	class Manager:
 			public Object<Manager>,
 
@@ -121,11 +156,45 @@ namespace gpwe::render{
 				Group, Texture, Framebuffer, Program, Pipeline
 			>
 	{
+		using Base = gpwe::Manager<Manager, ManagerKind::render, Group, Texture, Framebuffer, Program, Pipeline>;
+
 		public:
 			virtual ~Manager() = default;
 
 			virtual void present(const Camera *cam) noexcept = 0;
 
+			/**
+			 * @brief Copy out anything present will read into the snapshot's slot.
+			 * Called on the simulation thread in pipelined mode, while present may
+			 * be drawing an older slot on the render thread. Instance data included.
+			 */
+			virtual void extract(FrameSnapshot &snap){}
+
+			// the snapshot the next present draws, null when not pipelined
+			const FrameSnapshot *snapshot() const noexcept{ return m_snapshot; }
+			void setSnapshot(const FrameSnapshot *snap) noexcept{ m_snapshot = snap; }
+
+			/**
+			 * @brief Render resources are made on the thread owning the render context.
+			 * Goes through sys::renderCall, so blocks while pipelined and gives null
+			 * once rendering is shutting down.
+			 */
+			template<typename T, typename ... Args>
+			T *create(Args &&... args){
+				T *ret = nullptr;
+				sys::renderCall([&]{ ret = Base::template create<T>(std::forward<Args>(args)...); });
+				return ret;
+			}
+
+			template<typename T>
+			bool destroy(T *ptr){
+				bool ret = false;
+				sys::renderCall([&]{ ret = Base::destroy(ptr); });
+				return ret;
+			}
+
+			virtual Counters counters() const noexcept{ return {}; }
+
 			void setArg(void *arg) noexcept{ m_arg = arg; }
 
 			Group *createGroup(
@@ -167,6 +236,7 @@ namespace gpwe::render{
 			virtual void onRenderResize(std::uint16_t w, std::uint16_t h){}
 
 			void *m_arg = nullptr;
+			const FrameSnapshot *m_snapshot = nullptr;
 
 			std::uint16_t m_w = 0, m_h = 0;
 
@@ -179,6 +249,12 @@ namespace gpwe::render{
 
 	class Instance;
 
+	/**
+	 * @brief Instances of a set of shapes drawn together.
+	 * The group is a render resource, made through Manager::create. Its
+	 * instances belong to the simulation: create, destroy and write them
+	 * there, the renderer copies them out in extract.
+	 */
 	class Group:
 			public gpwe::Managed<Group, &Manager::doCreateGroup>,
 			public gpwe::Manager<Group, ManagerKind::data, Instance>
@@ -223,6 +299,9 @@ namespace gpwe::render{
 
 			std::uint32_t index() const noexcept{ return m_idx; }
 
+			// laid out as the group's instanceDataInfo, null if it has none
+			void *data() noexcept{ return m_group->instanceDataSize() ? m_group->dataPtr(m_idx) : nullptr; }
+
 		protected:
 			Instance(Group *group_, std::uint32_t idx_)
 				: m_group(group_), m_idx(idx_){}
@@ -283,6 +362,11 @@ namespace gpwe::render{
 	};
 }
 
+namespace gpwe{
+	// created and destroyed in bulk every time the scene changes
+	template<> inline constexpr bool poolManaged<render::Instance> = true;
+}
+
 #define GPWE_RENDER_PLUGIN(type, name, author, major, minor, patch)\
 	GPWE_PLUGIN(render, type, name, author, major, minor, patch)
 
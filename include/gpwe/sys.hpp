@@ -3,23 +3,38 @@
 
 #include <cstdint>
 #include <atomic>
+#include <exception>
 #include <functional>
+#include <thread>
 
 #include "util/Vector.hpp"
 #include "util/Ticker.hpp"
+#include "util/SimClock.hpp"
+#include "util/TimerWheel.hpp"
+#include "util/FramePacer.hpp"
+#include "util/FrameStats.hpp"
 #include "util/Thread.hpp"
 #include "util/WorkQueue.hpp"
+#include "util/CommandQueue.hpp"
+#include "util/JobSystem.hpp"
 
 #include "Manager.hpp"
+#include "memory.hpp"
 
 namespace gpwe::sys{
 	using PresentFn = Fn<void()>;
+	using RenderContextFn = Fn<void()>;
 
 	class Manager: public gpwe::Manager<Manager, ManagerKind::sys>{
 		public:
 			template<typename T>
 			using Ptr = UniquePtr<T>;
 
+			enum class ThreadIdx{
+				worker, render, physics, app,
+				count
+			};
+
 			Manager();
 			virtual ~Manager();
 
@@ -35,8 +50,85 @@ namespace gpwe::sys{
 			void exit();
 			void quit(){ exit(); }
 
+			// false once exit is called, for hosts driving update themselves
+			bool running() const noexcept{ return m_running; }
+
 			int exec(PresentFn presentFn);
 
+			static constexpr Nat32 maxFrameLatency = 2;
+
+			/**
+			 * @brief Let simulation run up to \p frames ahead of rendering.
+			 * With 0 every manager updates in sequence on the calling thread. Otherwise
+			 * rendering and presenting move to their own thread, working from a
+			 * snapshot of each simulated frame. Takes effect on the next exec.
+			 * Only safe with a render manager whose extract copies out everything
+			 * present reads, instance data included.
+			 */
+			void setFrameLatency(Nat32 frames);
+
+			Nat32 frameLatency() const noexcept{ return m_frameLatency; }
+
+			/**
+			 * @brief Hooks for moving the render context between threads.
+			 * When pipelining starts the calling thread releases the context and the
+			 * render thread acquires it, and the other way around when it stops.
+			 */
+			void setRenderContextFns(RenderContextFn acquire, RenderContextFn release){
+				m_acquireRenderContext = std::move(acquire);
+				m_releaseRenderContext = std::move(release);
+			}
+
+			/**
+			 * @brief Run \p f on whichever thread owns the render context, and wait for it.
+			 * Needed for creating render resources while pipelined. Exceptions from
+			 * \p f are rethrown here. Once a pipelined exec starts shutting down
+			 * \p f is not run and false is returned, until the context is back on
+			 * the exec thread.
+			 */
+			template<typename F>
+			bool renderCall(F &&f){
+				// counted before the check, so shutdown serves every call that got past it
+				m_renderCalls.fetch_add(1);
+
+				struct Leave{
+					std::atomic<Nat32> &calls;
+					~Leave(){ calls.fetch_sub(1); }
+				} leave{ m_renderCalls };
+
+				if(m_renderStopping.load()){
+					return false;
+				}
+
+				if(!m_pipelined || m_renderThreadId.load() == std::this_thread::get_id()){
+					f();
+					return true;
+				}
+
+				std::atomic_bool done = false;
+				std::exception_ptr err;
+
+				post(ThreadIdx::render, [&f, &done, &err]{
+					try{
+						f();
+					}
+					catch(...){
+						err = std::current_exception();
+					}
+
+					done.store(true, std::memory_order_release);
+					done.notify_one();
+				});
+
+				done.wait(false, std::memory_order_acquire);
+
+				if(err){
+					std::rethrow_exception(err);
+				}
+
+				return true;
+			}
+
 			void setLogManager(Ptr<LogManager> manager);
 			void setRenderManager(Ptr<RenderManager> manager);
 			void setPhysicsManager(Ptr<PhysicsManager> manager);
@@ -65,9 +157,55 @@ namespace gpwe::sys{
 			UiManager *uiManager() noexcept{ return m_uiManager.get(); }
 			AppManager *appManager() noexcept{ return m_appManager.get(); }
 
+			JobSystem *jobSystem() noexcept{ return m_jobSystem.get(); }
+
+			SimClock &simClock() noexcept{ return m_simClock; }
+
+			TimerWheel &timers() noexcept{ return m_timers; }
+
+			/**
+			 * @brief Pacing for the exec loop.
+			 * Unlimited by default; set a target and idle rate to stop exec
+			 * spinning a core when vsync is off or the scene is static.
+			 */
+			FramePacer &framePacer() noexcept{ return m_framePacer; }
+
+			// keep running at the full frame rate, callable from any thread
+			void markDirty() noexcept{ m_framePacer.markDirty(); }
+
+			/**
+			 * @brief Rolling p50/p95/p99/max of each manager's time per frame.
+			 * Collected every frame over the last window() frames.
+			 */
+			const FrameStats &frameStats() const noexcept{ return m_frameStats; }
+
+			FrameStats::Summary frameStats(FrameStats::Stage stage) const{ return m_frameStats.summary(stage); }
+
+			void setFrameStatsWindow(std::size_t frames){ m_frameStats.setWindow(frames); }
+
+			// log frameStats().report() this often, 0 to stop
+			void setFrameStatsLogInterval(std::chrono::seconds interval);
+
+			WorkQueue &workQueue(ThreadIdx idx) noexcept{ return m_workQueues[(std::size_t)idx]; }
+			CommandQueue &commandQueue(ThreadIdx idx) noexcept{ return m_commandQueues[(std::size_t)idx]; }
+
+			/**
+			 * @brief Queue a command to run on the thread owning \p idx.
+			 * Lock-free and allocation free, commands run in order at the start
+			 * of that thread's next tick.
+			 */
+			template<typename F>
+			void post(ThreadIdx idx, F &&f){
+				m_commandQueues[(std::size_t)idx].post(std::forward<F>(f));
+				markDirty();
+			}
+
 		private:
 			template<bool YieldLoop = false, typename ManagerT>
-			void threadFn(UniquePtr<ManagerT> &m, WorkQueue &work){
+			void threadFn(UniquePtr<ManagerT> &m, WorkQueue &work, CommandQueue &cmds){
+				// manager threads are frame critical, keep allocation latency bounded
+				sys::enableRealtimeHeap();
+
 				while(!m_running){
 					work.doWorkOr(std::this_thread::yield);
 				}
@@ -76,6 +214,7 @@ namespace gpwe::sys{
 
 				while(m_running){
 					auto dt = ticker.tick();
+					cmds.drain();
 					m->update(dt);
 					if constexpr(YieldLoop){
 						work.doWorkOr(std::this_thread::yield);
@@ -85,11 +224,19 @@ namespace gpwe::sys{
 					}
 				}
 
+				cmds.drain();
 				m.reset();
+
+				sys::disableRealtimeHeap();
 			}
 
+			void updateSimulation(float dt);
+			void updateRender(float dt, const Camera *cam);
+			int execPipelined(PresentFn &presentFn);
+
 			void initBaseLibraries();
 			void loadPlugins();
+			void reportLeaks();
 
 			Ptr<LogManager> m_logManager;
 			Ptr<RenderManager> m_renderManager;
@@ -99,6 +246,8 @@ namespace gpwe::sys{
 			Ptr<UiManager> m_uiManager;
 			Ptr<AppManager> m_appManager;
 
+			Ptr<JobSystem> m_jobSystem;
+
 			Vector<resource::Plugin*> m_plugins;
 			Vector<resource::Plugin*> m_logPlugins;
 			Vector<resource::Plugin*> m_renderPlugins;
@@ -107,13 +256,9 @@ namespace gpwe::sys{
 			Vector<resource::Plugin*> m_worldPlugins;
 			Vector<resource::Plugin*> m_appPlugins;
 
-			enum class ThreadIdx{
-				worker, render, physics, app,
-				count
-			};
-
 			Thread m_threads[(std::size_t)ThreadIdx::count];
 			WorkQueue m_workQueues[(std::size_t)ThreadIdx::count];
+			CommandQueue m_commandQueues[(std::size_t)ThreadIdx::count];
 
 			int m_argc = 0; char **m_argv = nullptr;
 
@@ -122,6 +267,20 @@ namespace gpwe::sys{
 
 			std::atomic_bool m_running = false;
 
+			SimClock m_simClock;
+			TimerWheel m_timers;
+			FramePacer m_framePacer;
+			FrameStats m_frameStats;
+			TimerWheel::Handle m_frameStatsLog;
+			Str m_profileTracePath;
+
+			Nat32 m_frameLatency = 0;
+			std::atomic_bool m_pipelined = false;
+			std::atomic<std::thread::id> m_renderThreadId;
+			std::atomic_bool m_renderStopping = false;
+			std::atomic<Nat32> m_renderCalls = 0;
+			RenderContextFn m_acquireRenderContext, m_releaseRenderContext;
+
 			static std::atomic_flag m_initFlag;
 	};
 
@@ -146,6 +305,30 @@ namespace gpwe::sys{
 	WorldManager *worldManager() noexcept;
 	UiManager *uiManager() noexcept;
 	AppManager *appManager() noexcept;
+
+	// shared work-stealing pool, valid between init and shutdown from any thread
+	JobSystem *jobSystem() noexcept;
+
+	SimClock *simClock() noexcept;
+
+	/**
+	 * @brief Timers advanced with real frame time before the app updates.
+	 * Callbacks run on the main thread or as jobs. Scheduling and cancelling
+	 * are fine from any thread, null outside init and shutdown.
+	 */
+	TimerWheel *timers() noexcept;
+
+	// from any thread, but only markDirty on it is thread safe; null outside init and shutdown
+	FramePacer *framePacer() noexcept;
+
+	// keep running at the full frame rate, callable from any thread
+	void markDirty() noexcept;
+
+	// see Manager::renderCall, runs \p f in place when there's no manager
+	bool renderCall(FnRef<void()> f);
+
+	// from any thread, adding and summarising are both thread safe; null outside init and shutdown
+	const FrameStats *frameStats() noexcept;
 }
 
 namespace gpwe::resource{ inline Manager *manager(){ return sys::resourceManager(); } }
@@ -1,8 +1,11 @@
 ﻿#ifndef GPWE_ALLOCATOR_HPP
 #define GPWE_ALLOCATOR_HPP 1
 
+#include <cstddef>
+#include <cstdint>
 #include <atomic>
 #include <memory>
+#include <type_traits>
 #include <variant>
 
 #include "gpwe/config.hpp"
@@ -13,16 +16,87 @@ namespace gpwe{
 	namespace sys{
 		void *alloc(std::size_t n);
 		void free(void *ptr);
+
+		// usable size of a block returned by alloc
+		std::size_t allocSize(const void *ptr) noexcept;
+
+		/**
+		 * @brief Allocate scratch memory from the calling thread's frame arena.
+		 * Memory is released in bulk; it stays valid until the end of the frame
+		 * after the one it was allocated in.
+		 */
+		void *frameAlloc(std::size_t n, std::size_t align = alignof(std::max_align_t));
+
+		/**
+		 * @brief Serve this thread's allocations from a bounded-latency TLSF heap.
+		 * \p reserve bytes are mapped up front so the heap doesn't grow mid-frame.
+		 * Blocks may still be freed from any thread.
+		 */
+		void enableRealtimeHeap(std::size_t reserve = 4 * 1024 * 1024);
+		void disableRealtimeHeap() noexcept;
+		bool realtimeHeapEnabled() noexcept;
+
+		// begin a new frame, called from sys::Manager::update
+		void nextFrame() noexcept;
+
+		std::uint64_t frameIndex() noexcept;
+
+		/**
+		 * @brief Make the calling thread see \p frame as the current frame.
+		 * For threads running behind the simulation, like the render thread in
+		 * pipelined mode, so frame memory lives as long as their own frames do.
+		 */
+		void pinFrame(std::uint64_t frame) noexcept;
+		void unpinFrame() noexcept;
 	}
 
-	template<typename T>
+	/**
+	 * @brief Polymorphic source of memory, like std::pmr::memory_resource.
+	 * Used by Allocator<T, MemoryResource> and UniquePtr<T, MemoryResource>.
+	 */
+	class MemoryResource{
+		public:
+			virtual ~MemoryResource() = default;
+
+			void *allocate(std::size_t n, std::size_t align = alignof(std::max_align_t)){
+				return doAllocate(n, align);
+			}
+
+			void deallocate(void *ptr, std::size_t n, std::size_t align = alignof(std::max_align_t)) noexcept{
+				doDeallocate(ptr, n, align);
+			}
+
+			bool isEqual(const MemoryResource &other) const noexcept{
+				return this == &other || doIsEqual(other);
+			}
+
+		protected:
+			virtual void *doAllocate(std::size_t n, std::size_t align) = 0;
+			virtual void doDeallocate(void *ptr, std::size_t n, std::size_t align) noexcept = 0;
+			virtual bool doIsEqual(const MemoryResource &other) const noexcept{ return false; }
+	};
+
+	namespace sys{
+		// resource forwarding to sys::alloc/sys::free
+		MemoryResource *defaultResource() noexcept;
+	}
+
+	/**
+	 * @brief Allocator used by every gpwe container.
+	 * With the default \p Res it is stateless and goes straight to sys::alloc,
+	 * with MemoryResource it carries a pointer to the resource to use.
+	 */
+	template<typename T, typename Res = void>
 	class Allocator{
+		static_assert(std::is_void_v<Res>, "Allocator resource must be void or MemoryResource");
+
 		public:
 			using allocator_type = Allocator<T>;
 			using value_type = T;
 			using pointer = T*;
 			using const_pointer = const T*;
 			using size_type = std::size_t;
+			using is_always_equal = std::true_type;
 
 			template<typename U>
 			struct rebind{
@@ -58,6 +132,115 @@ namespace gpwe{
 			void deallocate(pointer p) noexcept{
 				sys::free(p);
 			}
+
+			template<typename U>
+			bool operator==(const Allocator<U>&) const noexcept{ return true; }
+
+			template<typename U>
+			bool operator!=(const Allocator<U>&) const noexcept{ return false; }
+	};
+
+	template<typename T>
+	class Allocator<T, MemoryResource>{
+		public:
+			using allocator_type = Allocator<T, MemoryResource>;
+			using value_type = T;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using size_type = std::size_t;
+
+			template<typename U>
+			struct rebind{
+				using other = Allocator<U, MemoryResource>;
+			};
+
+			Allocator() noexcept
+				: m_res(sys::defaultResource()){}
+
+			Allocator(MemoryResource *res) noexcept
+				: m_res(res){}
+
+			Allocator(const Allocator &a) noexcept = default;
+
+			template<typename U>
+			Allocator(const Allocator<U, MemoryResource> &a) noexcept
+				: m_res(a.resource()){}
+
+			~Allocator() = default;
+
+			Allocator &operator=(const Allocator&) = delete;
+
+			template<typename ... Args>
+			void construct(pointer p, Args &&... args) noexcept(noexcept(T{std::forward<Args>(args)...})){
+				new(p) T(std::forward<Args>(args)...);
+			}
+
+			void destroy(pointer p) noexcept{
+				p->~T();
+			}
+
+			pointer allocate(size_type n){
+				return reinterpret_cast<pointer>(m_res->allocate(n * sizeof(T), alignof(T)));
+			}
+
+			void deallocate(pointer p, size_type n) noexcept{
+				m_res->deallocate(p, n * sizeof(T), alignof(T));
+			}
+
+			MemoryResource *resource() const noexcept{ return m_res; }
+
+			template<typename U>
+			bool operator==(const Allocator<U, MemoryResource> &other) const noexcept{
+				return m_res->isEqual(*other.resource());
+			}
+
+			template<typename U>
+			bool operator!=(const Allocator<U, MemoryResource> &other) const noexcept{
+				return !(*this == other);
+			}
+
+		private:
+			MemoryResource *m_res;
+	};
+
+	/**
+	 * @brief Allocator for short-lived data backed by the per-thread frame arena.
+	 * Deallocation is a no-op, everything is reclaimed two frames later.
+	 */
+	template<typename T>
+	class FrameAllocator{
+		public:
+			using allocator_type = FrameAllocator<T>;
+			using value_type = T;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using size_type = std::size_t;
+
+			template<typename U>
+			struct rebind{
+				using other = FrameAllocator<U>;
+			};
+
+			FrameAllocator() noexcept = default;
+
+			FrameAllocator(const FrameAllocator &a) noexcept = default;
+
+			template<typename U>
+			FrameAllocator(const FrameAllocator<U> &a) noexcept{}
+
+			~FrameAllocator() = default;
+
+			pointer allocate(size_type n) noexcept{
+				return reinterpret_cast<pointer>(sys::frameAlloc(n * sizeof(T), alignof(T)));
+			}
+
+			void deallocate(pointer p, size_type n) noexcept{}
+
+			template<typename U>
+			bool operator==(const FrameAllocator<U>&) const noexcept{ return true; }
+
+			template<typename U>
+			bool operator!=(const FrameAllocator<U>&) const noexcept{ return false; }
 	};
 
 	using SmallBuffer = char[GPWE_STATIC_BUFFER_SIZE];
@@ -65,15 +248,101 @@ namespace gpwe{
 	using InPlaceT = std::in_place_t;
 	inline InPlaceT InPlace;
 
-	template<typename T>
+	namespace detail{
+		template<typename Res>
+		class UniquePtrStorage;
+
+		template<>
+		class UniquePtrStorage<void>{
+			public:
+				template<typename U, typename ... Args>
+				U *create(Args &&... args){
+					auto mem = sys::alloc(sizeof(U));
+
+					try{
+						return new(mem) U(std::forward<Args>(args)...);
+					}
+					catch(...){
+						sys::free(mem);
+						throw;
+					}
+				}
+
+				template<typename U>
+				void adopt(const UniquePtrStorage&, U*) noexcept{}
+
+				template<typename U>
+				void adopt(U*) noexcept{}
+
+				void dealloc(void *mem) noexcept{ sys::free(mem); }
+		};
+
+		// remembers where the object came from and how big it really was
+		template<>
+		class UniquePtrStorage<MemoryResource>{
+			public:
+				UniquePtrStorage() noexcept
+					: m_res(sys::defaultResource()){}
+
+				explicit UniquePtrStorage(MemoryResource *res) noexcept
+					: m_res(res){}
+
+				template<typename U, typename ... Args>
+				U *create(Args &&... args){
+					auto mem = m_res->allocate(sizeof(U), alignof(U));
+
+					try{
+						auto ret = new(mem) U(std::forward<Args>(args)...);
+						adopt(ret);
+						return ret;
+					}
+					catch(...){
+						m_res->deallocate(mem, sizeof(U), alignof(U));
+						throw;
+					}
+				}
+
+				template<typename U>
+				void adopt(const UniquePtrStorage &other, U*) noexcept{
+					m_res = other.m_res;
+					m_size = other.m_size;
+					m_align = other.m_align;
+				}
+
+				template<typename U>
+				void adopt(U*) noexcept{
+					m_size = sizeof(U);
+					m_align = alignof(U);
+				}
+
+				void dealloc(void *mem) noexcept{ m_res->deallocate(mem, m_size, m_align); }
+
+				MemoryResource *resource() const noexcept{ return m_res; }
+
+			private:
+				MemoryResource *m_res;
+				std::size_t m_size = 0, m_align = 0;
+		};
+	}
+
+	/**
+	 * @brief Owning pointer to an object created with \ref makeUnique.
+	 * @tparam Res void for the default heap or MemoryResource for a custom one
+	 */
+	template<typename T, typename Res = void>
 	class UniquePtr{
 		public:
 			UniquePtr() noexcept
 				: m_ptr(nullptr){}
 
 			template<typename ... Args>
-			UniquePtr(InPlaceT, Args &&... args)
-				noexcept(noexcept(T(std::forward<Args>(args)...)))
+			UniquePtr(InPlaceT, Args &&... args){
+				construct(std::forward<Args>(args)...);
+			}
+
+			template<typename ... Args>
+			UniquePtr(InPlaceT, MemoryResource *res, Args &&... args) requires std::is_same_v<Res, MemoryResource>
+				: m_storage(res)
 			{
 				construct(std::forward<Args>(args)...);
 			}
@@ -83,16 +352,31 @@ namespace gpwe{
 
 			template<typename U>
 			explicit UniquePtr(U *ptr) noexcept
-				: m_ptr(ptr){}
+				: m_ptr(ptr)
+			{
+				m_storage.adopt(ptr);
+			}
+
+			// ptr must have been allocated from res as a U
+			template<typename U>
+			UniquePtr(MemoryResource *res, U *ptr) noexcept requires std::is_same_v<Res, MemoryResource>
+				: m_ptr(ptr), m_storage(res)
+			{
+				m_storage.adopt(ptr);
+			}
 
 			UniquePtr(const UniquePtr&) = delete;
 
 			template<typename U>
-			UniquePtr(UniquePtr<U> &&other) noexcept
-				: m_ptr(other.release()){}
+			UniquePtr(UniquePtr<U, Res> &&other) noexcept{
+				m_storage.adopt(other.m_storage, other.get());
+				m_ptr = other.release();
+			}
 
-			UniquePtr(UniquePtr &&other) noexcept
-				: m_ptr(other.release()){}
+			UniquePtr(UniquePtr &&other) noexcept{
+				m_storage.adopt(other.m_storage, other.get());
+				m_ptr = other.release();
+			}
 
 			~UniquePtr(){
 				destroy();
@@ -100,12 +384,22 @@ namespace gpwe{
 
 			UniquePtr &operator=(const UniquePtr&) = delete;
 
+			UniquePtr &operator=(UniquePtr &&other) noexcept{
+				if(this != &other){
+					destroy();
+					m_storage.adopt(other.m_storage, other.get());
+					m_ptr = other.release();
+				}
+
+				return *this;
+			}
+
 			template<typename U>
-			UniquePtr &operator=(UniquePtr<U> &&other) noexcept{
+			UniquePtr &operator=(UniquePtr<U, Res> &&other) noexcept{
 				if((void*)this != (void*)&other){
-					static Allocator<T> alloc;
-					auto otherPtr = other.m_ptr.exchange(nullptr);
-					reset(otherPtr);
+					destroy();
+					m_storage.adopt(other.m_storage, other.get());
+					m_ptr = other.release();
 				}
 
 				return *this;
@@ -120,8 +414,8 @@ namespace gpwe{
 				return *this;
 			}
 
-			template<typename U>
-			inline bool operator<(const UniquePtr<U> &other) const noexcept{
+			template<typename U, typename URes>
+			inline bool operator<(const UniquePtr<U, URes> &other) const noexcept{
 				return m_ptr < other.m_ptr;
 			}
 
@@ -130,6 +424,12 @@ namespace gpwe{
 				return m_ptr < other;
 			}
 
+			// binaryFind compares both ways around
+			template<typename U>
+			friend inline bool operator<(const U *lhs, const UniquePtr &rhs) noexcept{
+				return lhs < rhs.m_ptr;
+			}
+
 			inline operator bool() const noexcept{ return !!m_ptr; }
 
 			inline T *operator->() noexcept{ return m_ptr; }
@@ -142,47 +442,68 @@ namespace gpwe{
 				return m_ptr.exchange(nullptr);
 			}
 
-			void reset(T *ptr = nullptr) noexcept{
-				static Allocator<T> alloc;
-				if(auto old = m_ptr.exchange(ptr)){
-					alloc.destroy(old);
-					alloc.deallocate(old);
-				}
+			void reset() noexcept{
+				destroy();
+			}
+
+			// ptr must come from the same place as this pointer's objects
+			template<typename U>
+			void reset(U *ptr) noexcept{
+				destroy();
+				m_storage.adopt(ptr);
+				m_ptr = ptr;
+			}
+
+			MemoryResource *resource() const noexcept requires std::is_same_v<Res, MemoryResource>{
+				return m_storage.resource();
 			}
 
 		private:
 			template<typename ... Args>
 			void construct(Args &&... args){
-				static Allocator<T> alloc;
-				auto ptr = alloc.allocate(1);
-				alloc.construct(ptr, std::forward<Args>(args)...);
-				if(auto oldPtr = m_ptr.exchange(ptr)){
-					alloc.destroy(oldPtr);
-					alloc.deallocate(oldPtr);
-				}
+				m_ptr = m_storage.template create<T>(std::forward<Args>(args)...);
 			}
 
-			void destroy(){
-				static Allocator<T> alloc;
+			void destroy() noexcept{
 				if(auto ptr = m_ptr.exchange(nullptr)){
-					alloc.deallocate(ptr);
-					alloc.destroy(ptr);
+					// a base pointer may not point at the start of the allocation
+					void *mem = ptr;
+					if constexpr(std::is_polymorphic_v<T>){
+						mem = dynamic_cast<void*>(ptr);
+					}
+
+					ptr->~T();
+					m_storage.dealloc(mem);
 				}
 			}
 
 			std::atomic<T*> m_ptr = nullptr;
+			[[no_unique_address]] detail::UniquePtrStorage<Res> m_storage;
 
-			template<typename U>
+			template<typename U, typename URes>
 			friend class UniquePtr;
 	};
 
 	template<typename T>
 	UniquePtr(T*) -> UniquePtr<T>;
 
+	namespace detail{
+		template<typename ... Args>
+		struct IsResourceFirst: std::false_type{};
+
+		template<typename Arg, typename ... Args>
+		struct IsResourceFirst<Arg, Args...>: std::is_base_of<MemoryResource, std::remove_cvref_t<Arg>>{};
+	}
+
 	template<typename T, typename ... Args>
-	UniquePtr<T> makeUnique(Args &&... args){
+	UniquePtr<T> makeUnique(Args &&... args) requires (!detail::IsResourceFirst<Args...>::value){
 		return UniquePtr<T>(InPlace, std::forward<Args>(args)...);
 	}
+
+	template<typename T, typename ... Args>
+	UniquePtr<T, MemoryResource> makeUnique(MemoryResource &res, Args &&... args){
+		return UniquePtr<T, MemoryResource>(InPlace, &res, std::forward<Args>(args)...);
+	}
 }
 
 #endif // !GPWE_ALLOCATOR_HPP
@@ -0,0 +1,189 @@
+#ifndef GPWE_COMMANDQUEUE_HPP
+#define GPWE_COMMANDQUEUE_HPP 1
+
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <type_traits>
+
+#include "Allocator.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief Bounded lock-free queue of commands, many producers and one consumer.
+	 * Each command is a callable stored inline in a cache line sized slot, so
+	 * posting never allocates; captures are limited to payloadSize bytes and
+	 * checked at compile time. The consumer runs commands in batches with drain.
+	 * Commands must not throw.
+	 */
+	class CommandQueue{
+		public:
+			static constexpr std::size_t payloadSize = 48;
+			static constexpr std::size_t payloadAlign = 16;
+
+			// capacity is rounded up to a power of two
+			explicit CommandQueue(std::size_t capacity = 1024)
+				: m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1)
+			{
+				m_slots = reinterpret_cast<Slot*>(sys::defaultResource()->allocate(sizeof(Slot) * (m_mask + 1), alignof(Slot)));
+
+				for(std::size_t i = 0; i <= m_mask; i++){
+					new(m_slots + i) Slot;
+					m_slots[i].seq.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			CommandQueue(const CommandQueue&) = delete;
+
+			~CommandQueue(){
+				// including whatever the last commands post
+				while(drain()){}
+
+				for(std::size_t i = 0; i <= m_mask; i++){
+					m_slots[i].~Slot();
+				}
+
+				sys::defaultResource()->deallocate(m_slots, sizeof(Slot) * capacity(), alignof(Slot));
+			}
+
+			CommandQueue &operator=(const CommandQueue&) = delete;
+
+			std::size_t capacity() const noexcept{ return m_mask + 1; }
+
+			// commands posted and not yet taken, may be stale by the time it returns
+			std::size_t size() const noexcept{
+				const auto head = m_head.load(std::memory_order_relaxed);
+				const auto tail = m_tail.load(std::memory_order_acquire);
+				return std::intptr_t(tail - head) > 0 ? tail - head : 0;
+			}
+
+			bool empty() const noexcept{
+				const auto head = m_head.load(std::memory_order_relaxed);
+				return m_slots[head & m_mask].seq.load(std::memory_order_acquire) != (head + 1);
+			}
+
+			// false if the queue is full
+			template<typename F>
+			bool tryPost(F &&f){
+				using FnT = std::decay_t<F>;
+
+				static_assert(sizeof(FnT) <= payloadSize, "Command too big for inline storage");
+				static_assert(alignof(FnT) <= payloadAlign, "Command alignment too big for inline storage");
+
+				auto pos = m_tail.load(std::memory_order_relaxed);
+				Slot *slot;
+
+				while(true){
+					slot = m_slots + (pos & m_mask);
+
+					const auto seq = slot->seq.load(std::memory_order_acquire);
+					const auto diff = std::intptr_t(seq) - std::intptr_t(pos);
+
+					if(diff == 0){
+						if(m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+							break;
+						}
+					}
+					else if(diff < 0){
+						return false;
+					}
+					else{
+						pos = m_tail.load(std::memory_order_relaxed);
+					}
+				}
+
+				new(slot->payload) FnT(std::forward<F>(f));
+
+				slot->take = [](void *dst, void *src) noexcept -> RunFn{
+					auto &&fn = *std::launder(reinterpret_cast<FnT*>(src));
+					new(dst) FnT(std::move(fn));
+					fn.~FnT();
+
+					return [](void *payload) noexcept{
+						auto &&fn = *std::launder(reinterpret_cast<FnT*>(payload));
+						fn();
+						fn.~FnT();
+					};
+				};
+
+				slot->seq.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+
+			/**
+			 * @brief Post a command, waiting for room if the queue is full.
+			 * Called from the thread that last drained it drains in place instead;
+			 * a thread that has never drained just waits, so producers that may
+			 * also consume before their first drain should use tryPost.
+			 */
+			template<typename F>
+			void post(F &&f){
+				while(!tryPost(std::forward<F>(f))){
+					if(m_consumer.load(std::memory_order_relaxed) == std::this_thread::get_id()){
+						drain(capacity() / 2);
+					}
+					else{
+						std::this_thread::yield();
+					}
+				}
+			}
+
+			/**
+			 * @brief Run up to n commands in the order posted, only call from the consumer thread.
+			 * Commands posted while draining wait for the next drain. Each command is
+			 * moved out of its slot before it runs, so it may post to this queue even
+			 * when full.
+			 */
+			std::size_t drain(std::size_t n = SIZE_MAX) noexcept{
+				m_consumer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+				const auto end = m_tail.load(std::memory_order_acquire);
+				std::size_t i = 0;
+
+				for(; i < n; i++){
+					// reloaded every time, a command may have drained some itself
+					const auto head = m_head.load(std::memory_order_relaxed);
+					if(std::intptr_t(end - head) <= 0) break;
+
+					auto slot = m_slots + (head & m_mask);
+
+					if(slot->seq.load(std::memory_order_acquire) != (head + 1)){
+						break;
+					}
+
+					alignas(payloadAlign) unsigned char payload[payloadSize];
+					const auto run = slot->take(payload, slot->payload);
+
+					slot->seq.store(head + m_mask + 1, std::memory_order_release);
+					m_head.store(head + 1, std::memory_order_relaxed);
+
+					run(payload);
+				}
+
+				return i;
+			}
+
+		private:
+			using RunFn = void(*)(void *payload) noexcept;
+
+			struct alignas(64) Slot{
+				std::atomic<std::size_t> seq;
+				RunFn(*take)(void *dst, void *src) noexcept; // moves the command to dst
+				alignas(payloadAlign) unsigned char payload[payloadSize];
+			};
+
+			static_assert(sizeof(Slot) == 64);
+
+			Slot *m_slots;
+			std::size_t m_mask;
+
+			// padded rather than aligned, queues live inside heap allocated managers
+			char m_pad0[64];
+			std::atomic<std::size_t> m_tail = 0;
+			char m_pad1[64 - sizeof(std::atomic<std::size_t>)];
+			std::atomic<std::size_t> m_head = 0;
+			std::atomic<std::thread::id> m_consumer;
+	};
+}
+
+#endif // !GPWE_COMMANDQUEUE_HPP
@@ -1,35 +1,306 @@
 #ifndef GPWE_EVENT_HPP
 #define GPWE_EVENT_HPP 1
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+
 #include "Fn.hpp"
-#include "List.hpp"
+#include "Vector.hpp"
+#include "CommandQueue.hpp"
 #include "algo.hpp"
 
 namespace gpwe{
+	/**
+	 * @brief Listener list with immediate and deferred dispatch.
+	 * Slots live in one contiguous array and are named by generation checked
+	 * handles, so a stale handle never removes someone else's slot. Slots can
+	 * be added and removed from inside a listener; those changes apply once the
+	 * outermost emit returns. Removing a slot may change the call order of the
+	 * remaining ones.
+	 *
+	 * emit calls every listener on the calling thread. post copies the arguments
+	 * into a lock-free queue that any thread may push to, and flush emits them
+	 * in order on whichever single thread owns the event.
+	 */
 	template<typename ... Vals>
 	class Event{
 		public:
 			using Slot = Fn<void(Vals...)>;
-			using SlotIt = typename List<Slot>::const_iterator;
+
+			class Handle{
+				public:
+					Handle() noexcept = default;
+
+					explicit operator bool() const noexcept{ return m_gen != 0; }
+
+					bool operator==(const Handle&) const noexcept = default;
+
+				private:
+					Handle(Nat32 id_, Nat32 gen_) noexcept
+						: m_id(id_), m_gen(gen_){}
+
+					Nat32 m_id = 0, m_gen = 0;
+
+					friend class Event;
+			};
+
+			Event() = default;
+
+			Event(const Event&) = delete;
+
+			~Event(){
+				// anything still queued is dropped, the listeners may already be gone
+				m_discard = true;
+			}
+
+			Event &operator=(const Event&) = delete;
+
+			std::size_t numSlots() const noexcept{ return m_numSlots; }
 
 			template<typename F>
-			SlotIt addFn(F &&f){
-				return m_slots.emplace(m_slots.end(), std::forward<F>(f));
+			Handle addFn(F &&f){
+				Nat32 id;
+
+				if(m_freeIds != nil){
+					id = m_freeIds;
+					m_freeIds = m_ids[id].dense;
+				}
+				else{
+					id = Nat32(m_ids.size());
+					m_ids.emplace_back(IdEntry{ nil, 1 });
+				}
+
+				if(m_emitDepth){
+					// growing m_slots now could move a listener that is running
+					m_ids[id].dense = pendingBit | Nat32(m_added.size());
+					m_added.emplace_back(Added{ id, Slot(std::forward<F>(f)) });
+				}
+				else{
+					m_ids[id].dense = Nat32(m_slots.size());
+					m_slots.emplace_back(std::forward<F>(f));
+					m_slotIds.emplace_back(id);
+				}
+
+				++m_numSlots;
+				return Handle(id, m_ids[id].gen);
 			}
 
-			void removeFn(SlotIt f){
-				m_slots.erase(f);
+			// false if the handle is stale
+			bool removeFn(Handle handle){
+				if(!handle || handle.m_id >= m_ids.size()) return false;
+
+				auto &&entry = m_ids[handle.m_id];
+				if(entry.gen != handle.m_gen || entry.dense == nil) return false;
+
+				const auto dense = entry.dense;
+				freeId(handle.m_id);
+				--m_numSlots;
+
+				if(dense & pendingBit){
+					auto &&added = m_added[dense & ~pendingBit];
+					added.slot = nullptr;
+					added.id = nil;
+				}
+				else if(m_emitDepth){
+					// the slot might be the one running, it's destroyed after the emit
+					m_slotIds[dense] = nil;
+					++m_numDead;
+				}
+				else{
+					eraseDense(dense);
+				}
+
+				return true;
 			}
 
 			template<typename ... UVals>
 			void emit(UVals &&... vals){
-				for(auto &&f : m_slots){
-					f(std::forward<UVals>(vals)...);
+				static_assert(std::is_invocable_v<Slot&, UVals&...>, "Arguments don't match the event");
+
+				// the loop is only instantiated once per event type, not per argument pack
+				dispatch([&vals...](Slot &slot){ slot(vals...); });
+			}
+
+			/**
+			 * @brief Queue an emit for the next flush, callable from any thread, never blocks.
+			 * Arguments are copied inline into a CommandQueue slot, so together with a
+			 * pointer they must fit CommandQueue::payloadSize (48 bytes) or it won't
+			 * compile. Past the queue capacity (256 unless setQueueCapacity says
+			 * otherwise) posts spill into a locked, allocating overflow list until a
+			 * flush catches up, so the flushing thread can post as much as it likes.
+			 */
+			template<typename ... UVals>
+			void post(UVals &&... vals){
+				static_assert((std::is_copy_constructible_v<std::decay_t<Vals>> && ...), "Posted event arguments must be copyable");
+				static_assert(std::is_constructible_v<std::tuple<std::decay_t<Vals>...>, UVals&&...>, "Arguments don't match the event");
+
+				auto cmd = [this, args = std::tuple<std::decay_t<Vals>...>(std::forward<UVals>(vals)...)]() mutable{
+					if(m_discard) return;
+					std::apply([this](auto &... as){ emit(as...); }, args);
+				};
+
+				auto &&q = queue();
+
+				// once anything overflows everything does until a flush catches up, which keeps the order
+				if(!m_overflowing.load(std::memory_order_acquire) && q.tryPost(std::move(cmd))){
+					return;
+				}
+
+				std::lock_guard lock(m_overflowMut);
+				m_overflow.emplace_back(std::move(cmd));
+				m_overflowing.store(true, std::memory_order_release);
+			}
+
+			/**
+			 * @brief Emit up to \p n posted events in order, only ever from one thread at a time.
+			 * Never more than were queued on entry, events posted by listeners wait
+			 * for the next flush.
+			 */
+			std::size_t flush(std::size_t n = SIZE_MAX){
+				auto q = m_queuePtr.load(std::memory_order_acquire);
+				if(!q) return 0;
+
+				const auto queued = q->size();
+				auto ret = q->drain(std::min(n, queued));
+
+				// overflow was posted after everything in the queue, it goes once the queue is out
+				if(ret < queued || ret == n || !m_overflowing.load(std::memory_order_acquire)){
+					return ret;
+				}
+
+				Vector<Fn<void()>> batch;
+
+				{
+					std::lock_guard lock(m_overflowMut);
+
+					const auto end = m_overflow.begin() + std::min(n - ret, m_overflow.size());
+					batch.assign(std::make_move_iterator(m_overflow.begin()), std::make_move_iterator(end));
+					m_overflow.erase(m_overflow.begin(), end);
+
+					if(m_overflow.empty()){
+						m_overflowing.store(false, std::memory_order_release);
+					}
+				}
+
+				for(auto &&cmd : batch){
+					cmd();
 				}
+
+				return ret + batch.size();
 			}
 
+			bool hasPosted() const noexcept{
+				if(m_overflowing.load(std::memory_order_acquire)) return true;
+
+				auto q = m_queuePtr.load(std::memory_order_acquire);
+				return q && !q->empty();
+			}
+
+			// capacity of the post queue, only has an effect before the first post
+			void setQueueCapacity(std::size_t capacity) noexcept{ m_queueCapacity = capacity; }
+
 		private:
-			List<Slot> m_slots;
+			static constexpr Nat32 nil = ~Nat32(0);
+			static constexpr Nat32 pendingBit = Nat32(1) << 31;
+
+			struct IdEntry{
+				Nat32 dense; // index into m_slots, into m_added with pendingBit, next free id when free
+				Nat32 gen;
+			};
+
+			struct Added{
+				Nat32 id;
+				Slot slot;
+			};
+
+			void dispatch(FnRef<void(Slot&)> call){
+				++m_emitDepth;
+
+				// size taken up front, slots added by listeners wait for the next emit
+				for(std::size_t i = 0, n = m_slots.size(); i < n; i++){
+					if(m_slotIds[i] != nil) call(m_slots[i]);
+				}
+
+				if(--m_emitDepth == 0 && (m_numDead || !m_added.empty())){
+					applyChanges();
+				}
+			}
+
+			void freeId(Nat32 id) noexcept{
+				auto &&entry = m_ids[id];
+
+				// skip 0 so a default handle never matches
+				if(++entry.gen == 0) entry.gen = 1;
+
+				entry.dense = m_freeIds;
+				m_freeIds = id;
+			}
+
+			void eraseDense(Nat32 dense){
+				const auto last = Nat32(m_slots.size() - 1);
+
+				if(dense != last){
+					m_slots[dense] = std::move(m_slots[last]);
+					m_slotIds[dense] = m_slotIds[last];
+
+					if(m_slotIds[dense] != nil){
+						m_ids[m_slotIds[dense]].dense = dense;
+					}
+				}
+
+				m_slots.pop_back();
+				m_slotIds.pop_back();
+			}
+
+			void applyChanges(){
+				// from the back so swapped in slots have already been checked
+				for(auto i = m_slots.size(); m_numDead && i-- > 0;){
+					if(m_slotIds[i] == nil){
+						eraseDense(Nat32(i));
+						--m_numDead;
+					}
+				}
+
+				for(auto &&added : m_added){
+					if(added.id == nil) continue;
+
+					m_ids[added.id].dense = Nat32(m_slots.size());
+					m_slots.emplace_back(std::move(added.slot));
+					m_slotIds.emplace_back(added.id);
+				}
+
+				m_added.clear();
+			}
+
+			CommandQueue &queue(){
+				std::call_once(m_queueOnce, [this]{
+					m_queue = makeUnique<CommandQueue>(m_queueCapacity);
+					m_queuePtr.store(m_queue.get(), std::memory_order_release);
+				});
+
+				return *m_queue.get();
+			}
+
+			Vector<Slot> m_slots;
+			Vector<Nat32> m_slotIds;
+			Vector<IdEntry> m_ids;
+			Vector<Added> m_added;
+			Nat32 m_freeIds = nil;
+			Nat32 m_numSlots = 0, m_numDead = 0;
+			Nat32 m_emitDepth = 0;
+
+			bool m_discard = false;
+			std::size_t m_queueCapacity = 256;
+			std::mutex m_overflowMut;
+			std::atomic_bool m_overflowing = false;
+			Vector<Fn<void()>> m_overflow;
+			std::once_flag m_queueOnce;
+			std::atomic<CommandQueue*> m_queuePtr = nullptr;
+			UniquePtr<CommandQueue> m_queue;
 	};
 }
 
@@ -1,7 +1,11 @@
 #ifndef GPWE_FN_HPP
 #define GPWE_FN_HPP 1
 
+#include <cstring>
 #include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
 
 #include "Allocator.hpp"
 
@@ -11,118 +15,276 @@ namespace gpwe{
 			const char *what() const noexcept override{ return "empty function called"; }
 	};
 
+	class NonCopyableFnError: public std::exception{
+		public:
+			const char *what() const noexcept override{ return "copy of function holding a move-only functor"; }
+	};
+
 	template<typename...>
 	class Fn;
 
+	/**
+	 * @brief Owning type-erased function, like std::function but move-only friendly.
+	 * Functors up to GPWE_STATIC_BUFFER_SIZE bytes are stored inline, bigger ones
+	 * are boxed on the heap (or a MemoryResource). Inline trivially copyable
+	 * functors and all boxed ones are relocated with a memcpy.
+	 * Copying an Fn holding a move-only functor throws NonCopyableFnError.
+	 */
 	template<typename Ret, typename ... Args>
 	class Fn<Ret(Args...)>{
 		public:
 			using Sig = Ret(Args...);
 			using FnPtr = Sig*;
 
-			Fn() noexcept
-				: Fn([](Args...) -> Ret{ throw EmptyFnError{}; }){}
+			Fn() noexcept = default;
+
+			Fn(std::nullptr_t) noexcept{}
 
 			template<typename F>
-			Fn(F &&f) noexcept{
-				new(m_fnBuffer) Functor<F>(std::forward<F>(f));
+			Fn(F &&f) requires (!std::is_same_v<std::remove_cvref_t<F>, Fn> && std::is_invocable_r_v<Ret, std::decay_t<F>&, Args...>){
+				construct<std::decay_t<F>>(nullptr, std::forward<F>(f));
 			}
 
-			Fn(Ret(*ptr)(Args...)) noexcept{
-				new(m_fnBuffer) Functor<Ret(*)(Args...)>(ptr);
+			template<typename F>
+			Fn(std::allocator_arg_t, MemoryResource *res, F &&f) requires std::is_invocable_r_v<Ret, std::decay_t<F>&, Args...>{
+				construct<std::decay_t<F>>(res, std::forward<F>(f));
 			}
 
 			Fn(Fn &&other) noexcept{
-				auto otherFn = reinterpret_cast<FunctorBase*>(other.m_fnBuffer);
-				otherFn->cloneMove(m_fnBuffer);
-				other.reset();
+				moveFrom(other);
 			}
 
-			Fn(const Fn &other) noexcept{
-				auto otherFn = reinterpret_cast<const FunctorBase*>(other.m_fnBuffer);
-				otherFn->clone(m_fnBuffer);
+			Fn(const Fn &other){
+				copyFrom(other);
 			}
 
 			~Fn(){
-				reinterpret_cast<FunctorBase*>(m_fnBuffer)->~FunctorBase();
+				reset();
 			}
 
 			Fn &operator=(Fn &&other) noexcept{
 				if(&other != this){
-					reinterpret_cast<FunctorBase*>(m_fnBuffer)->~FunctorBase();
-					auto otherFn = reinterpret_cast<FunctorBase*>(other.m_fnBuffer);
-					otherFn->cloneMove(m_fnBuffer);
-					other.reset();
+					reset();
+					moveFrom(other);
 				}
 
 				return *this;
 			}
 
-			Fn &operator=(const Fn &other) noexcept{
+			Fn &operator=(const Fn &other){
 				if(&other != this){
-					reinterpret_cast<FunctorBase*>(m_fnBuffer)->~FunctorBase();
-					auto otherFn = reinterpret_cast<const FunctorBase*>(other.m_fnBuffer);
-					otherFn->clone(m_fnBuffer);
+					Fn tmp(other);
+					reset();
+					moveFrom(tmp);
 				}
 
 				return *this;
 			}
 
-			template<typename ... UArgs>
-			Ret operator()(UArgs &&... args) const{
-				const auto fn = reinterpret_cast<const FunctorBase*>(m_fnBuffer);
-				return fn->call(std::forward<UArgs>(args)...);
+			Fn &operator=(std::nullptr_t) noexcept{
+				reset();
+				return *this;
 			}
 
+			Ret operator()(Args ... args) const{
+				if(!m_vtable) [[unlikely]]{
+					throw EmptyFnError{};
+				}
+
+				return m_vtable->call(const_cast<void*>(static_cast<const void*>(m_buffer)), std::forward<Args>(args)...);
+			}
+
+			explicit operator bool() const noexcept{ return m_vtable != nullptr; }
+
 			void reset() noexcept{
-				auto ptr = reinterpret_cast<FunctorBase*>(m_fnBuffer);
-				ptr->~FunctorBase();
-				construct([](Args...) -> Ret{ throw EmptyFnError{}; });
+				if(m_vtable){
+					if(m_vtable->destroy) m_vtable->destroy(m_buffer);
+					m_vtable = nullptr;
+				}
 			}
 
 		private:
+			struct VTable{
+				Ret(*call)(void *storage, Args&&... args);
+
+				// null when a memcpy of the storage does the job
+				void(*move)(void *dst, void *src) noexcept;
+
+				void(*copy)(void *dst, const void *src);
+
+				// null when trivially destructible
+				void(*destroy)(void *storage) noexcept;
+			};
+
 			template<typename F>
-			void construct(F &&f){
-				new(m_fnBuffer) Functor<F>(std::forward<F>(f));
-			}
+			static constexpr bool isInline =
+				sizeof(F) <= sizeof(SmallBuffer) &&
+				alignof(F) <= alignof(std::max_align_t) &&
+				std::is_nothrow_move_constructible_v<F>;
 
-			struct FunctorBase{
-				virtual ~FunctorBase() = default;
-				virtual Ret call(Args...) const = 0;
-				virtual void clone(void *mem) const = 0;
-				virtual void cloneMove(void *mem) = 0;
+			template<typename F>
+			struct Boxed{
+				MemoryResource *res;
+				F fn;
 			};
 
 			template<typename F>
-			struct Functor: FunctorBase{
-				static_assert(sizeof(F) <= sizeof(SmallBuffer), "GPWE_STATIC_BUFFER_SIZE too small");
+			static F &inlineFn(void *storage) noexcept{
+				return *std::launder(reinterpret_cast<F*>(storage));
+			}
 
-				template<typename G>
-				Functor(G &&g)
-					: fn(std::forward<G>(g))
-				{}
+			template<typename F>
+			static Boxed<F> *&boxedFn(void *storage) noexcept{
+				return *reinterpret_cast<Boxed<F>**>(storage);
+			}
+
+			template<typename F, typename ... FArgs>
+			static Boxed<F> *makeBox(MemoryResource *res, FArgs &&... fargs){
+				void *mem = res ? res->allocate(sizeof(Boxed<F>), alignof(Boxed<F>)) : sys::alloc(sizeof(Boxed<F>));
+
+				try{
+					return new(mem) Boxed<F>{ res, F(std::forward<FArgs>(fargs)...) };
+				}
+				catch(...){
+					if(res) res->deallocate(mem, sizeof(Boxed<F>), alignof(Boxed<F>));
+					else sys::free(mem);
+					throw;
+				}
+			}
+
+			template<typename F>
+			static void freeBox(Boxed<F> *box) noexcept{
+				auto res = box->res;
+				box->~Boxed<F>();
+				if(res) res->deallocate(box, sizeof(Boxed<F>), alignof(Boxed<F>));
+				else sys::free(box);
+			}
+
+			template<typename F>
+			static constexpr VTable inlineVTable = {
+				[](void *storage, Args&&... args) -> Ret{
+					return static_cast<Ret>(std::invoke(inlineFn<F>(storage), std::forward<Args>(args)...));
+				},
+				std::is_trivially_copyable_v<F> ? nullptr : +[](void *dst, void *src) noexcept{
+					new(dst) F(std::move(inlineFn<F>(src)));
+					inlineFn<F>(src).~F();
+				},
+				[](void *dst, const void *src){
+					if constexpr(std::is_copy_constructible_v<F>){
+						new(dst) F(inlineFn<F>(const_cast<void*>(src)));
+					}
+					else{
+						throw NonCopyableFnError{};
+					}
+				},
+				std::is_trivially_destructible_v<F> ? nullptr : +[](void *storage) noexcept{
+					inlineFn<F>(storage).~F();
+				}
+			};
 
-				Ret call(Args ... args) const override{
-					if constexpr(std::is_same_v<void, Ret>){
-						fn(args...);
+			template<typename F>
+			static constexpr VTable boxedVTable = {
+				[](void *storage, Args&&... args) -> Ret{
+					return static_cast<Ret>(std::invoke(boxedFn<F>(storage)->fn, std::forward<Args>(args)...));
+				},
+				nullptr,
+				[](void *dst, const void *src){
+					if constexpr(std::is_copy_constructible_v<F>){
+						auto box = boxedFn<F>(const_cast<void*>(src));
+						boxedFn<F>(dst) = makeBox<F>(box->res, box->fn);
 					}
 					else{
-						return fn(args...);
+						throw NonCopyableFnError{};
 					}
+				},
+				[](void *storage) noexcept{
+					freeBox(boxedFn<F>(storage));
 				}
+			};
 
-				void clone(void *mem) const override{
-					new(mem) Functor<F>(fn);
+			template<typename F, typename G>
+			void construct(MemoryResource *res, G &&g){
+				if constexpr(std::is_pointer_v<std::remove_cvref_t<G>> || std::is_member_pointer_v<std::remove_cvref_t<G>>){
+					if(!g) return;
 				}
 
-				void cloneMove(void *mem) override{
-					new(mem) Functor<F>(std::move(fn));
+				if constexpr(isInline<F>){
+					new(m_buffer) F(std::forward<G>(g));
+					m_vtable = &inlineVTable<F>;
+				}
+				else{
+					boxedFn<F>(m_buffer) = makeBox<F>(res, std::forward<G>(g));
+					m_vtable = &boxedVTable<F>;
 				}
+			}
 
-				F fn;
+			void moveFrom(Fn &other) noexcept{
+				if(!other.m_vtable) return;
+
+				if(other.m_vtable->move){
+					other.m_vtable->move(m_buffer, other.m_buffer);
+				}
+				else{
+					std::memcpy(m_buffer, other.m_buffer, sizeof(SmallBuffer));
+				}
+
+				m_vtable = std::exchange(other.m_vtable, nullptr);
+			}
+
+			void copyFrom(const Fn &other){
+				if(!other.m_vtable) return;
+				other.m_vtable->copy(m_buffer, other.m_buffer);
+				m_vtable = other.m_vtable;
+			}
+
+			const VTable *m_vtable = nullptr;
+			alignas(std::max_align_t) SmallBuffer m_buffer;
+	};
+
+	template<typename...>
+	class FnRef;
+
+	/**
+	 * @brief Non-owning reference to a callable, never allocates.
+	 * Only valid while the referenced callable is; meant for parameters.
+	 */
+	template<typename Ret, typename ... Args>
+	class FnRef<Ret(Args...)>{
+		public:
+			template<typename F>
+			FnRef(F &&f) noexcept requires (!std::is_same_v<std::remove_cvref_t<F>, FnRef> && std::is_invocable_r_v<Ret, F&, Args...>){
+				using FnT = std::remove_reference_t<F>;
+
+				if constexpr(std::is_function_v<std::remove_pointer_t<std::decay_t<F>>>){
+					m_storage.fnPtr = reinterpret_cast<void(*)()>(static_cast<std::decay_t<F>>(f));
+					m_call = [](Storage s, Args&&... args) -> Ret{
+						return static_cast<Ret>(reinterpret_cast<std::decay_t<F>>(s.fnPtr)(std::forward<Args>(args)...));
+					};
+				}
+				else{
+					m_storage.obj = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+					m_call = [](Storage s, Args&&... args) -> Ret{
+						return static_cast<Ret>(std::invoke(*static_cast<FnT*>(s.obj), std::forward<Args>(args)...));
+					};
+				}
+			}
+
+			FnRef(const FnRef&) noexcept = default;
+
+			FnRef &operator=(const FnRef&) noexcept = default;
+
+			Ret operator()(Args ... args) const{
+				return m_call(m_storage, std::forward<Args>(args)...);
+			}
+
+		private:
+			union Storage{
+				void *obj;
+				void(*fnPtr)();
 			};
 
-			SmallBuffer m_fnBuffer;
+			Storage m_storage;
+			Ret(*m_call)(Storage, Args&&...);
 	};
 }
 
@@ -0,0 +1,88 @@
+#ifndef GPWE_FRAMEPACER_HPP
+#define GPWE_FRAMEPACER_HPP 1
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace gpwe{
+	/**
+	 * @brief Holds a frame loop to a target rate without burning a core.
+	 * Waits sleep for most of the remaining frame time then spin the rest, the
+	 * spin margin follows the measured oversleep of the OS scheduler. When no
+	 * one has called markDirty for a while the idle rate is used instead, and a
+	 * markDirty wakes an idle wait straight away.
+	 */
+	class FramePacer{
+		public:
+			using Clock = std::chrono::steady_clock;
+			using Duration = std::chrono::nanoseconds;
+
+			struct FrameTiming{
+				Duration period; // frame interval aimed for, 0 when unlimited
+				Duration work; // time between the end of the last wait and this one
+				Duration slack; // period - work, negative when the frame ran long
+				Duration waited; // time actually spent in wait
+				bool idle;
+			};
+
+			explicit FramePacer(float targetFps = 0.f);
+
+			FramePacer(const FramePacer&) = delete;
+
+			FramePacer &operator=(const FramePacer&) = delete;
+
+			// 0 for unlimited
+			void setTargetFps(float fps) noexcept;
+			float targetFps() const noexcept{ return m_targetFps; }
+
+			// rate used once idle, 0 disables idle throttling
+			void setIdleFps(float fps) noexcept;
+			float idleFps() const noexcept{ return m_idleFps; }
+
+			// how long after the last markDirty before dropping to the idle rate
+			void setIdleDelay(Duration delay) noexcept{ m_idleDelay = delay; }
+			Duration idleDelay() const noexcept{ return m_idleDelay; }
+
+			// something changed that needs frames at the full rate, callable from any thread
+			void markDirty() noexcept;
+
+			bool idle() const noexcept{ return m_idle; }
+
+			// wait until the next frame is due and record the timing of the one just finished
+			void wait();
+
+			const FrameTiming &lastFrame() const noexcept{ return m_last; }
+
+			// smoothed over recent frames
+			Duration averageSlack() const noexcept{ return m_avgSlack; }
+			Duration averageWork() const noexcept{ return m_avgWork; }
+
+			// current estimate of how late a sleep wakes up
+			Duration sleepJitter() const noexcept{ return m_jitter; }
+
+		private:
+			static Duration periodFor(float fps) noexcept;
+
+			void sleepUntil(Clock::time_point deadline);
+			void idleUntil(Clock::time_point deadline);
+
+			float m_targetFps = 0.f, m_idleFps = 0.f;
+			Duration m_period = Duration::zero(), m_idlePeriod = Duration::zero();
+			Duration m_idleDelay = std::chrono::milliseconds(500);
+
+			Clock::time_point m_lastWaitEnd, m_deadline, m_lastDirty;
+			bool m_idle = false;
+
+			Duration m_jitter = std::chrono::microseconds(500);
+			Duration m_avgSlack = Duration::zero(), m_avgWork = Duration::zero();
+			FrameTiming m_last{};
+
+			std::atomic_bool m_dirty = true, m_sleeping = false;
+			std::mutex m_mut;
+			std::condition_variable m_cv;
+	};
+}
+
+#endif // !GPWE_FRAMEPACER_HPP
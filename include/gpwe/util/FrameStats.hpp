@@ -0,0 +1,92 @@
+#ifndef GPWE_FRAMESTATS_HPP
+#define GPWE_FRAMESTATS_HPP 1
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "Histogram.hpp"
+#include "Str.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief Rolling per-stage frame time percentiles.
+	 * Stages add their time to the running frame from any thread; endFrame
+	 * moves the totals into one RollingHistogram per stage. Nothing allocates
+	 * outside of setWindow.
+	 */
+	class FrameStats{
+		public:
+			using Clock = std::chrono::steady_clock;
+			using Duration = std::chrono::nanoseconds;
+
+			enum class Stage{
+				frame, // time between endFrame calls
+				input, app, physics, render, present,
+				count
+			};
+
+			struct Summary{
+				Duration p50{}, p95{}, p99{}, max{};
+				std::size_t numFrames = 0;
+			};
+
+			// times a stage for as long as it lives
+			class Scope{
+				public:
+					Scope(FrameStats &stats, Stage stage) noexcept
+						: m_stats(stats), m_stage(stage), m_start(Clock::now()){}
+
+					Scope(const Scope&) = delete;
+
+					~Scope(){ m_stats.add(m_stage, Clock::now() - m_start); }
+
+					Scope &operator=(const Scope&) = delete;
+
+				private:
+					FrameStats &m_stats;
+					Stage m_stage;
+					Clock::time_point m_start;
+			};
+
+			static constexpr std::size_t numStages = std::size_t(Stage::count);
+
+			static StrView stageName(Stage stage) noexcept;
+
+			explicit FrameStats(std::size_t window_ = 600);
+
+			// in frames, clears the collected stats
+			void setWindow(std::size_t frames);
+			std::size_t window() const noexcept;
+
+			// callable from any thread, a stage timed more than once a frame adds up
+			void add(Stage stage, Duration dur) noexcept{
+				m_pending[std::size_t(stage)].fetch_add(Nat64(dur.count()), std::memory_order_relaxed);
+			}
+
+			void endFrame() noexcept;
+
+			// over the last window() frames
+			Summary summary(Stage stage) const;
+
+			/**
+			 * @brief Over every frame since construction or the last setWindow.
+			 * Kept in a fixed size histogram, so long runs cost no more memory
+			 * than short ones; percentiles are within 1/64, max is exact.
+			 */
+			Summary totalSummary(Stage stage) const;
+
+			// one line per stage, in milliseconds
+			Str report() const;
+
+		private:
+			mutable std::mutex m_mut;
+			RollingHistogram m_hists[numStages];
+			Histogram m_totals[numStages];
+			Nat64 m_totalMax[numStages] = {};
+			std::atomic<Nat64> m_pending[numStages] = {};
+			Clock::time_point m_lastFrame{};
+	};
+}
+
+#endif // !GPWE_FRAMESTATS_HPP
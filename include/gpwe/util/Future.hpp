@@ -0,0 +1,514 @@
+#ifndef GPWE_FUTURE_HPP
+#define GPWE_FUTURE_HPP 1
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "Allocator.hpp"
+#include "Fn.hpp"
+#include "Vector.hpp"
+#include "types.hpp"
+
+namespace gpwe{
+	class BrokenPromiseError: public std::exception{
+		public:
+			const char *what() const noexcept override{ return "promise destroyed without a result"; }
+	};
+
+	class InvalidFutureError: public std::exception{
+		public:
+			const char *what() const noexcept override{ return "use of an empty future"; }
+	};
+
+	class PromiseSatisfiedError: public std::exception{
+		public:
+			const char *what() const noexcept override{ return "promise already satisfied"; }
+	};
+
+	template<typename T>
+	class Future;
+
+	template<typename T>
+	class Promise;
+
+	namespace detail{
+		// run f on queue, through post (WorkQueue, CommandQueue) or run (JobSystem)
+		template<typename Queue, typename F>
+		void schedule(Queue &queue, F &&f){
+			if constexpr(requires{ queue.post(std::forward<F>(f)); }){
+				queue.post(std::forward<F>(f));
+			}
+			else{
+				queue.run(std::forward<F>(f));
+			}
+		}
+
+		/**
+		 * @brief State shared by a Promise and its Future.
+		 * One allocation holding the result inline. Takes a single continuation,
+		 * handed over with one atomic or on each side.
+		 */
+		template<typename T>
+		class FutureState{
+			public:
+				using Value = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+				static FutureState *create(){
+					return new(sys::alloc(sizeof(FutureState))) FutureState;
+				}
+
+				void ref() noexcept{ m_refs.fetch_add(1, std::memory_order_relaxed); }
+
+				void unref() noexcept{
+					if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+						this->~FutureState();
+						sys::free(this);
+					}
+				}
+
+				bool ready() const noexcept{
+					return m_flags.load(std::memory_order_acquire) & readyFlag;
+				}
+
+				template<typename ... Args>
+				void setValue(Args &&... args){
+					m_value.emplace(std::forward<Args>(args)...);
+					finish();
+				}
+
+				void setException(std::exception_ptr err){
+					m_exception = std::move(err);
+					finish();
+				}
+
+				void setContinuation(Fn<void()> fn){
+					m_continuation = std::move(fn);
+
+					const auto old = m_flags.fetch_or(continuationFlag, std::memory_order_acq_rel);
+					if(old & readyFlag){
+						std::exchange(m_continuation, nullptr)();
+					}
+				}
+
+				void wait() noexcept{
+					auto flags = m_flags.fetch_or(waitingFlag, std::memory_order_acquire) | waitingFlag;
+
+					while(!(flags & readyFlag)){
+						m_flags.wait(flags, std::memory_order_acquire);
+						flags = m_flags.load(std::memory_order_acquire);
+					}
+				}
+
+				Value take(){
+					if(m_exception) std::rethrow_exception(m_exception);
+					return std::move(*m_value);
+				}
+
+				std::exception_ptr exception() const noexcept{ return m_exception; }
+
+			private:
+				FutureState() noexcept = default;
+
+				~FutureState() = default;
+
+				static constexpr Nat8 readyFlag = 1, continuationFlag = 2, waitingFlag = 4;
+
+				void finish(){
+					const auto old = m_flags.fetch_or(readyFlag, std::memory_order_acq_rel);
+
+					if(old & waitingFlag){
+						m_flags.notify_all();
+					}
+
+					if(old & continuationFlag){
+						std::exchange(m_continuation, nullptr)();
+					}
+				}
+
+				std::atomic<Nat32> m_refs = 1;
+				std::atomic<Nat8> m_flags = 0;
+				std::optional<Value> m_value;
+				std::exception_ptr m_exception;
+				Fn<void()> m_continuation;
+		};
+
+		template<typename F, typename Arg>
+		struct ThenResultImpl{ using Type = std::invoke_result_t<F&, Arg>; };
+
+		template<typename F>
+		struct ThenResultImpl<F, void>{ using Type = std::invoke_result_t<F&>; };
+
+		template<typename F, typename T>
+		using ThenResult = typename ThenResultImpl<F, T>::Type;
+
+		template<typename R, typename F, typename ... Args>
+		void fulfill(Promise<R> &p, F &f, Args &&... args) noexcept;
+
+		struct FutureAccess{
+			// take the shared state, the caller inherits the reference
+			template<typename T>
+			static FutureState<T> *release(Future<T> &fut){
+				auto state = std::exchange(fut.m_state, nullptr);
+				if(!state) throw InvalidFutureError{};
+				return state;
+			}
+		};
+	}
+
+	/**
+	 * @brief Write end of a Future.
+	 * Destroying a promise without setting anything fails its future with
+	 * BrokenPromiseError.
+	 */
+	template<typename T>
+	class Promise{
+		public:
+			Promise()
+				: m_state(detail::FutureState<T>::create()){}
+
+			Promise(Promise &&other) noexcept
+				: m_state(std::exchange(other.m_state, nullptr)){}
+
+			Promise(const Promise&) = delete;
+
+			~Promise(){
+				if(m_state) setException(std::make_exception_ptr(BrokenPromiseError{}));
+			}
+
+			Promise &operator=(Promise &&other) noexcept{
+				if(&other != this){
+					if(m_state) setException(std::make_exception_ptr(BrokenPromiseError{}));
+					m_state = std::exchange(other.m_state, nullptr);
+				}
+
+				return *this;
+			}
+
+			Promise &operator=(const Promise&) = delete;
+
+			// may only be called once
+			Future<T> future() noexcept{
+				m_state->ref();
+				return Future<T>(m_state);
+			}
+
+			// the promise keeps its state if constructing the value throws, so it can still fail
+			template<typename ... Args>
+			void setValue(Args &&... args){
+				if(!m_state) throw PromiseSatisfiedError{};
+				m_state->setValue(std::forward<Args>(args)...);
+				std::exchange(m_state, nullptr)->unref();
+			}
+
+			void setException(std::exception_ptr err){
+				if(!m_state) throw PromiseSatisfiedError{};
+				auto state = std::exchange(m_state, nullptr);
+				state->setException(std::move(err));
+				state->unref();
+			}
+
+		private:
+			detail::FutureState<T> *m_state;
+	};
+
+	/**
+	 * @brief Read end of a Promise, a lighter std::future.
+	 * Results are stored inline in the one shared allocation. Use then() to
+	 * chain work instead of blocking in get(); a future takes one continuation.
+	 */
+	template<typename T>
+	class Future{
+		public:
+			using Value = T;
+
+			Future() noexcept = default;
+
+			Future(Future &&other) noexcept
+				: m_state(std::exchange(other.m_state, nullptr)){}
+
+			Future(const Future&) = delete;
+
+			~Future(){
+				if(m_state) m_state->unref();
+			}
+
+			Future &operator=(Future &&other) noexcept{
+				if(&other != this){
+					if(m_state) m_state->unref();
+					m_state = std::exchange(other.m_state, nullptr);
+				}
+
+				return *this;
+			}
+
+			Future &operator=(const Future&) = delete;
+
+			bool valid() const noexcept{ return m_state; }
+			bool ready() const noexcept{ return m_state && m_state->ready(); }
+
+			// block until the result is set
+			void wait() const{
+				state()->wait();
+			}
+
+			T get(){
+				wait();
+
+				auto state = std::exchange(m_state, nullptr);
+
+				struct Unref{
+					detail::FutureState<T> *state;
+					~Unref(){ state->unref(); }
+				} unref{ state };
+
+				if constexpr(std::is_void_v<T>){
+					state->take();
+				}
+				else{
+					return state->take();
+				}
+			}
+
+			// call f with the result on whichever thread sets it
+			template<typename F>
+			auto then(F f) -> Future<detail::ThenResult<F, T>>{
+				return thenImpl(static_cast<std::nullptr_t*>(nullptr), std::move(f));
+			}
+
+			// call f with the result from queue
+			template<typename Queue, typename F>
+			auto then(Queue &queue, F f) -> Future<detail::ThenResult<F, T>>{
+				return thenImpl(&queue, std::move(f));
+			}
+
+			auto operator co_await() noexcept{
+				struct Awaiter{
+					Future &fut;
+
+					bool await_ready() const noexcept{ return fut.ready(); }
+
+					void await_suspend(std::coroutine_handle<> h){
+						fut.state()->setContinuation([h]{ h.resume(); });
+					}
+
+					T await_resume(){ return fut.get(); }
+				};
+
+				return Awaiter{ *this };
+			}
+
+		private:
+			explicit Future(detail::FutureState<T> *state_) noexcept
+				: m_state(state_){}
+
+			detail::FutureState<T> *state() const{
+				if(!m_state) throw InvalidFutureError{};
+				return m_state;
+			}
+
+			template<typename Queue, typename F>
+			auto thenImpl(Queue *queue, F f) -> Future<detail::ThenResult<F, T>>{
+				using R = detail::ThenResult<F, T>;
+
+				auto src = std::exchange(m_state, nullptr);
+				if(!src) throw InvalidFutureError{};
+
+				Promise<R> p;
+				auto ret = p.future();
+
+				auto run = [src, p{std::move(p)}, f{std::move(f)}]() mutable{
+					struct Unref{
+						detail::FutureState<T> *state;
+						~Unref(){ state->unref(); }
+					} unref{ src };
+
+					if(auto err = src->exception()){
+						p.setException(std::move(err));
+					}
+					else if constexpr(std::is_void_v<T>){
+						detail::fulfill(p, f);
+					}
+					else{
+						detail::fulfill(p, f, src->take());
+					}
+				};
+
+				if constexpr(std::is_same_v<Queue, std::nullptr_t>){
+					src->setContinuation(std::move(run));
+				}
+				else{
+					src->setContinuation([queue, run{std::move(run)}]() mutable{
+						detail::schedule(*queue, std::move(run));
+					});
+				}
+
+				return ret;
+			}
+
+			detail::FutureState<T> *m_state = nullptr;
+
+			friend class Promise<T>;
+			friend struct detail::FutureAccess;
+	};
+
+	template<typename R, typename F, typename ... Args>
+	void detail::fulfill(Promise<R> &p, F &f, Args &&... args) noexcept{
+		try{
+			if constexpr(std::is_void_v<R>){
+				f(std::forward<Args>(args)...);
+				p.setValue();
+			}
+			else{
+				p.setValue(f(std::forward<Args>(args)...));
+			}
+		}
+		catch(...){
+			p.setException(std::current_exception());
+		}
+	}
+
+	// a future that is already ready
+	template<typename T, typename ... Args>
+	Future<T> makeReadyFuture(Args &&... args){
+		Promise<T> p;
+		auto ret = p.future();
+		p.setValue(std::forward<Args>(args)...);
+		return ret;
+	}
+
+	/**
+	 * @brief Ready once every future is.
+	 * Gives the results in order, or the first failure.
+	 */
+	template<typename T>
+	auto whenAll(Vector<Future<T>> futures){
+		using Result = std::conditional_t<std::is_void_v<T>, void, Vector<T>>;
+
+		struct State{
+			std::atomic<std::size_t> remaining;
+			std::atomic_flag failed = ATOMIC_FLAG_INIT;
+			Vector<std::optional<typename detail::FutureState<T>::Value>> values;
+			Promise<Result> promise;
+		};
+
+		auto state = new(sys::alloc(sizeof(State))) State;
+		state->remaining = futures.size() + 1;
+		state->values.resize(futures.size());
+
+		auto ret = state->promise.future();
+
+		auto finishOne = [](State *state){
+			if(state->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+			if(!state->failed.test()){
+				if constexpr(std::is_void_v<T>){
+					state->promise.setValue();
+				}
+				else{
+					Vector<T> results;
+					results.reserve(state->values.size());
+
+					for(auto &&val : state->values){
+						results.emplace_back(std::move(*val));
+					}
+
+					state->promise.setValue(std::move(results));
+				}
+			}
+
+			state->~State();
+			sys::free(state);
+		};
+
+		for(std::size_t i = 0; i < futures.size(); i++){
+			auto src = detail::FutureAccess::release(futures[i]);
+
+			src->setContinuation([state, src, i, finishOne]{
+				if(auto err = src->exception()){
+					if(!state->failed.test_and_set()){
+						state->promise.setException(std::move(err));
+					}
+				}
+				else{
+					state->values[i].emplace(src->take());
+				}
+
+				src->unref();
+				finishOne(state);
+			});
+		}
+
+		finishOne(state);
+
+		return ret;
+	}
+
+	template<typename T>
+	struct WhenAnyResult{
+		std::size_t index;
+		T value;
+	};
+
+	template<>
+	struct WhenAnyResult<void>{
+		std::size_t index;
+	};
+
+	/**
+	 * @brief Ready once the first future is, with its index and result.
+	 * An empty list fails with BrokenPromiseError.
+	 */
+	template<typename T>
+	Future<WhenAnyResult<T>> whenAny(Vector<Future<T>> futures){
+		struct State{
+			std::atomic<std::size_t> remaining;
+			std::atomic_flag done = ATOMIC_FLAG_INIT;
+			Promise<WhenAnyResult<T>> promise;
+		};
+
+		auto state = new(sys::alloc(sizeof(State))) State;
+		state->remaining = futures.size();
+
+		auto ret = state->promise.future();
+
+		if(futures.empty()){
+			state->~State();
+			sys::free(state);
+			return ret;
+		}
+
+		for(std::size_t i = 0; i < futures.size(); i++){
+			auto src = detail::FutureAccess::release(futures[i]);
+
+			src->setContinuation([state, src, i]{
+				if(!state->done.test_and_set()){
+					if(auto err = src->exception()){
+						state->promise.setException(std::move(err));
+					}
+					else if constexpr(std::is_void_v<T>){
+						state->promise.setValue(WhenAnyResult<void>{ i });
+					}
+					else{
+						state->promise.setValue(WhenAnyResult<T>{ i, src->take() });
+					}
+				}
+
+				src->unref();
+
+				if(state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1){
+					state->~State();
+					sys::free(state);
+				}
+			});
+		}
+
+		return ret;
+	}
+}
+
+#endif // !GPWE_FUTURE_HPP
@@ -0,0 +1,147 @@
+#ifndef GPWE_HISTOGRAM_HPP
+#define GPWE_HISTOGRAM_HPP 1
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "Vector.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief Fixed size log-linear histogram, in the style of HdrHistogram.
+	 * Values below 128 are exact, anything larger lands in one of 64 buckets
+	 * per power of two, so percentiles are within 1/64 of the true value.
+	 * Values of 2^40 and over are clamped. Counts live inline, recording
+	 * never allocates.
+	 */
+	class Histogram{
+		public:
+			static constexpr Nat32 subBits = 7;
+			static constexpr Nat32 maxBits = 40;
+
+			static constexpr Nat64 halfCount = Nat64(1) << (subBits - 1);
+			static constexpr Nat64 maxValue = (Nat64(1) << maxBits) - 1;
+			static constexpr std::size_t numBuckets = (maxBits - subBits) * halfCount + 2 * halfCount;
+
+			static constexpr std::size_t bucketIndex(Nat64 value) noexcept{
+				value = std::min(value, maxValue);
+				if(value < 2 * halfCount) return std::size_t(value);
+
+				const auto shift = Nat32(std::bit_width(value)) - subBits;
+				return std::size_t(shift * halfCount + (value >> shift));
+			}
+
+			// highest value that maps to the bucket
+			static constexpr Nat64 bucketValue(std::size_t idx) noexcept{
+				if(idx < 2 * halfCount) return idx;
+
+				const auto shift = idx / halfCount - 1;
+				const auto mantissa = idx - shift * halfCount;
+				return ((mantissa + 1) << shift) - 1;
+			}
+
+			void record(Nat64 value) noexcept{
+				++m_counts[bucketIndex(value)];
+				++m_total;
+			}
+
+			// take back a value recorded earlier
+			void remove(Nat64 value) noexcept{
+				--m_counts[bucketIndex(value)];
+				--m_total;
+			}
+
+			void reset() noexcept{
+				m_counts.fill(0);
+				m_total = 0;
+			}
+
+			Nat64 count() const noexcept{ return m_total; }
+
+			// p in [0, 100], 0 if nothing was recorded
+			Nat64 percentile(double p) const noexcept{
+				if(!m_total) return 0;
+
+				const auto rank = std::max<Nat64>(1, Nat64(std::clamp(p, 0.0, 100.0) / 100.0 * double(m_total) + 0.5));
+				Nat64 seen = 0;
+
+				for(std::size_t i = 0; i < numBuckets; i++){
+					seen += m_counts[i];
+					if(seen >= rank) return bucketValue(i);
+				}
+
+				return maxValue;
+			}
+
+			Nat64 max() const noexcept{
+				for(auto i = numBuckets; i-- > 0;){
+					if(m_counts[i]) return bucketValue(i);
+				}
+
+				return 0;
+			}
+
+		private:
+			std::array<Nat32, numBuckets> m_counts{};
+			Nat64 m_total = 0;
+	};
+
+	static_assert(Histogram::bucketIndex(Histogram::maxValue) == Histogram::numBuckets - 1);
+
+	/**
+	 * @brief Histogram over the last window() values.
+	 * Values are kept in a ring sized up front so the oldest one can be taken
+	 * back out; recording stays constant time and allocation free.
+	 */
+	class RollingHistogram{
+		public:
+			explicit RollingHistogram(std::size_t window_ = 600){ setWindow(window_); }
+
+			// clears everything recorded so far, allocates
+			void setWindow(std::size_t n){
+				m_values.assign(std::max<std::size_t>(n, 1), 0);
+				m_next = 0;
+				m_hist.reset();
+				m_exactMax = 0;
+			}
+
+			std::size_t window() const noexcept{ return m_values.size(); }
+
+			void record(Nat64 value) noexcept{
+				auto &&slot = m_values[m_next];
+
+				if(m_hist.count() == m_values.size()){
+					m_hist.remove(slot);
+				}
+
+				slot = value;
+				m_hist.record(value);
+				m_next = (m_next + 1) % m_values.size();
+				m_exactMax = 0;
+			}
+
+			const Histogram &histogram() const noexcept{ return m_hist; }
+
+			Nat64 count() const noexcept{ return m_hist.count(); }
+
+			Nat64 percentile(double p) const noexcept{ return m_hist.percentile(p); }
+
+			// exact, unlike the bucketed percentiles
+			Nat64 max() const noexcept{
+				if(!m_exactMax && m_hist.count()){
+					m_exactMax = *std::max_element(m_values.begin(), m_values.begin() + m_hist.count());
+				}
+
+				return m_exactMax;
+			}
+
+		private:
+			Histogram m_hist;
+			Vector<Nat64> m_values;
+			std::size_t m_next = 0;
+			mutable Nat64 m_exactMax = 0;
+	};
+}
+
+#endif // !GPWE_HISTOGRAM_HPP
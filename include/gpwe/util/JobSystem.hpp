@@ -0,0 +1,124 @@
+#ifndef GPWE_JOBSYSTEM_HPP
+#define GPWE_JOBSYSTEM_HPP 1
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Fn.hpp"
+#include "Vector.hpp"
+#include "Thread.hpp"
+#include "types.hpp"
+
+namespace gpwe{
+	enum class JobPriority: Nat8{
+		high, normal, low,
+		count
+	};
+
+	/**
+	 * @brief Counts outstanding jobs for fork/join.
+	 * Pass to JobSystem::run for every job in a group, then JobSystem::wait on it.
+	 */
+	class JobCounter{
+		public:
+			JobCounter() noexcept = default;
+
+			JobCounter(const JobCounter&) = delete;
+
+			JobCounter &operator=(const JobCounter&) = delete;
+
+			bool done() const noexcept{ return m_count.load(std::memory_order_acquire) == 0; }
+
+			Nat32 pending() const noexcept{ return m_count.load(std::memory_order_relaxed); }
+
+		private:
+			std::atomic<Nat32> m_count = 0;
+
+			friend class JobSystem;
+	};
+
+	/**
+	 * @brief Pool of worker threads with a work-stealing deque each.
+	 * Jobs run from a worker go on that worker's deque, jobs from any other
+	 * thread go on a shared injection queue. Idle workers steal, highest
+	 * priority first, then sleep until more work turns up.
+	 */
+	class JobSystem{
+		public:
+			using JobFn = Fn<void()>;
+
+			// numWorkers excludes the calling thread, which helps out in wait
+			explicit JobSystem(std::size_t numWorkers = defaultNumWorkers());
+
+			JobSystem(const JobSystem&) = delete;
+
+			~JobSystem();
+
+			JobSystem &operator=(const JobSystem&) = delete;
+
+			static std::size_t defaultNumWorkers() noexcept{
+				return std::max(1u, std::thread::hardware_concurrency()) - 1;
+			}
+
+			std::size_t numWorkers() const noexcept{ return m_workers.size(); }
+
+			void run(JobFn fn, JobCounter *counter = nullptr, JobPriority prio = JobPriority::normal);
+
+			void run(JobFn fn, JobCounter &counter, JobPriority prio = JobPriority::normal){
+				run(std::move(fn), &counter, prio);
+			}
+
+			// run jobs on the calling thread until counter reaches zero
+			void wait(const JobCounter &counter);
+
+			// run a single pending job on the calling thread, false if there was none
+			bool runOne();
+
+			/**
+			 * @brief Call f(i) for every i in [begin, end), grain indices per job.
+			 * Returns once every call has finished.
+			 */
+			template<typename F>
+			void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, F &&f, JobPriority prio = JobPriority::normal){
+				grain = std::max<std::size_t>(grain, 1);
+
+				JobCounter counter;
+
+				for(std::size_t i = begin; i < end; i += grain){
+					const auto last = std::min(end, i + grain);
+					run([&f, i, last]{ for(auto j = i; j < last; j++) f(j); }, &counter, prio);
+				}
+
+				wait(counter);
+			}
+
+		private:
+			struct Job;
+			class Deque;
+			struct Worker;
+
+			Job *findJob(Worker *self) noexcept;
+			Job *stealJob(Worker *self) noexcept;
+			Job *popInjected() noexcept;
+			void execute(Job *job) noexcept;
+			void workerFn(Worker *self);
+			void wake() noexcept;
+
+			Vector<Worker*> m_workers;
+
+			std::mutex m_injectMut;
+			Vector<Job*> m_injected[(std::size_t)JobPriority::count];
+			std::size_t m_injectedHead[(std::size_t)JobPriority::count] = {};
+
+			std::atomic<std::size_t> m_numQueued = 0;
+			std::atomic<std::size_t> m_numSleeping = 0;
+			std::mutex m_sleepMut;
+			std::condition_variable m_sleepCond;
+			std::atomic_bool m_running = true;
+	};
+}
+
+#endif // !GPWE_JOBSYSTEM_HPP
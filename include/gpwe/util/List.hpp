@@ -6,8 +6,8 @@
 #include "Allocator.hpp"
 
 namespace gpwe{
-	template<typename T>
-	using List = plf::list<T, Allocator<T>>;
+	template<typename T, typename Res = void>
+	using List = plf::list<T, Allocator<T, Res>>;
 }
 
 #endif // !GPWE_LIST_HPP
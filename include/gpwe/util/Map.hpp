@@ -8,8 +8,8 @@
 #include "Allocator.hpp"
 
 namespace gpwe{
-	template<typename Key, typename Val, typename Compare = std::less<void>>
-	using Map = std::map<Key, Val, Compare, Allocator<std::pair<const Key, Val>>>;
+	template<typename Key, typename Val, typename Compare = std::less<void>, typename Res = void>
+	using Map = std::map<Key, Val, Compare, Allocator<std::pair<const Key, Val>, Res>>;
 
 	template<typename Key, typename Val>
 	using HashMap = robin_hood::unordered_map<Key, Val>;
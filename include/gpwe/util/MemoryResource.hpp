@@ -0,0 +1,48 @@
+#ifndef GPWE_MEMORYRESOURCE_HPP
+#define GPWE_MEMORYRESOURCE_HPP 1
+
+#include "Allocator.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief Monotonic resource that frees everything at once.
+	 * Deallocation is a no-op; memory comes back on \ref release or destruction.
+	 * Not thread safe.
+	 */
+	class ArenaResource final: public MemoryResource{
+		public:
+			explicit ArenaResource(std::size_t blockSize = 64 * 1024, MemoryResource *upstream = sys::defaultResource()) noexcept;
+
+			ArenaResource(const ArenaResource&) = delete;
+
+			~ArenaResource();
+
+			ArenaResource &operator=(const ArenaResource&) = delete;
+
+			// give every block back to the upstream resource
+			void release() noexcept;
+
+			std::size_t bytesUsed() const noexcept{ return m_used; }
+			std::size_t bytesReserved() const noexcept{ return m_reserved; }
+
+			MemoryResource *upstream() const noexcept{ return m_upstream; }
+
+		protected:
+			void *doAllocate(std::size_t n, std::size_t align) override;
+			void doDeallocate(void *ptr, std::size_t n, std::size_t align) noexcept override{}
+
+		private:
+			struct Block{
+				Block *next;
+				std::size_t size;
+			};
+
+			MemoryResource *m_upstream;
+			Block *m_blocks = nullptr;
+			char *m_cur = nullptr, *m_end = nullptr;
+			std::size_t m_blockSize, m_nextBlockSize;
+			std::size_t m_used = 0, m_reserved = 0;
+	};
+}
+
+#endif // !GPWE_MEMORYRESOURCE_HPP
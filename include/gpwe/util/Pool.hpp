@@ -0,0 +1,87 @@
+#ifndef GPWE_POOL_HPP
+#define GPWE_POOL_HPP 1
+
+#include <atomic>
+
+#include "Allocator.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief Type erased pool of fixed-size blocks.
+	 * Blocks are packed into span sized chunks and handed out lowest address
+	 * first, so live objects stay close together. Blocks know their pool, so
+	 * they may be released with sys::free (and so UniquePtr) from any thread.
+	 * Memory tracking counts each block against the tag that was current when
+	 * its chunk was made, see sys::MemoryTagScope.
+	 */
+	class PoolBase{
+		public:
+			PoolBase(std::size_t objSize, std::size_t objAlign) noexcept;
+
+			PoolBase(const PoolBase&) = delete;
+
+			// chunks are only released if every block has been returned
+			~PoolBase();
+
+			PoolBase &operator=(const PoolBase&) = delete;
+
+			void *alloc();
+			void free(void *ptr) noexcept;
+
+			std::size_t objSize() const noexcept{ return m_objSize; }
+			std::size_t numLive() const noexcept{ return m_numLive; }
+			std::size_t numChunks() const noexcept{ return m_numChunks; }
+
+		private:
+			void lock() noexcept;
+			void unlock() noexcept;
+
+			void grow();
+
+			std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+			void *m_free = nullptr;
+			void *m_chunks = nullptr;
+			std::size_t m_objSize;
+			std::size_t m_numLive = 0, m_numChunks = 0;
+	};
+
+	template<typename T>
+	class Pool: public PoolBase{
+		public:
+			Pool() noexcept
+				: PoolBase(sizeof(T), alignof(T)){}
+
+			template<typename U = T, typename ... Args>
+			UniquePtr<U> make(Args &&... args){
+				static_assert(sizeof(U) <= sizeof(T) && alignof(U) <= alignof(T), "Type too big for pool");
+
+				auto mem = alloc();
+
+				try{
+					return UniquePtr<U>(new(mem) U(std::forward<Args>(args)...));
+				}
+				catch(...){
+					free(mem);
+					throw;
+				}
+			}
+	};
+
+	/**
+	 * @brief Pool shared by every object of type T.
+	 * Never destroyed, pooled objects may outlive static destruction.
+	 */
+	template<typename T>
+	Pool<T> &pool(){
+		static auto ret = new(sys::alloc(sizeof(Pool<T>))) Pool<T>();
+		return *ret;
+	}
+
+	// like makeUnique, but from the shared pool for T
+	template<typename T, typename ... Args>
+	UniquePtr<T> makePooled(Args &&... args){
+		return pool<T>().make(std::forward<Args>(args)...);
+	}
+}
+
+#endif // !GPWE_POOL_HPP
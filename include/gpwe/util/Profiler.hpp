@@ -0,0 +1,85 @@
+#ifndef GPWE_PROFILER_HPP
+#define GPWE_PROFILER_HPP 1
+
+#include "gpwe/config.hpp"
+
+#include "Vector.hpp"
+#include "Str.hpp"
+
+/**
+ * CPU profiler
+ *
+ * Zones are recorded into per-thread lock-free rings and collected into a
+ * history of the last maxFrames() frames at every frame marker. Only active
+ * when built with GPWE_PROFILING, otherwise the macros compile to nothing
+ * and the history stays empty.
+ */
+
+namespace gpwe::prof{
+	constexpr bool enabled() noexcept{ return GPWE_PROFILING; }
+
+	struct Zone{
+		const char *name; // not copied, use string literals
+		Nat64 start, end; // nanoseconds since the profiler started
+		Nat32 thread;
+		Nat32 depth; // zones open on the same thread when this one began
+	};
+
+	struct Frame{
+		Nat64 index;
+		Nat64 start, end; // end is 0 for the frame still running
+		Vector<Zone> zones; // every thread's zones that began during the frame
+	};
+
+	// nanoseconds since the profiler started
+	Nat64 now() noexcept;
+
+	Nat32 enterZone() noexcept;
+	void leaveZone(const char *name, Nat64 start, Nat32 depth) noexcept;
+
+	// end the current frame and collect what every thread recorded, called from sys::Manager::update
+	void frameMark();
+
+	void setMaxFrames(std::size_t n);
+	std::size_t maxFrames() noexcept;
+
+	// copy of the retained frames, oldest first
+	Vector<Frame> frames();
+
+	// zones lost to full thread rings
+	Nat64 numDropped() noexcept;
+
+	// Chrome trace event JSON of the retained frames, loads in chrome://tracing and Perfetto
+	Str chromeTrace();
+	bool writeChromeTrace(StrView path);
+
+	class Scope{
+		public:
+			explicit Scope(const char *name_) noexcept
+				: m_name(name_), m_depth(enterZone()), m_start(now()){}
+
+			Scope(const Scope&) = delete;
+
+			~Scope(){ leaveZone(m_name, m_start, m_depth); }
+
+			Scope &operator=(const Scope&) = delete;
+
+		private:
+			const char *m_name;
+			Nat32 m_depth;
+			Nat64 m_start;
+	};
+}
+
+#define GPWE_PROFILE_CAT_(a, b) a##b
+#define GPWE_PROFILE_CAT(a, b) GPWE_PROFILE_CAT_(a, b)
+
+#if GPWE_PROFILING
+#define GPWE_PROFILE_SCOPE(name) ::gpwe::prof::Scope GPWE_PROFILE_CAT(gpweProfileScope_, __LINE__)(name)
+#define GPWE_PROFILE_FRAME() ::gpwe::prof::frameMark()
+#else
+#define GPWE_PROFILE_SCOPE(name) ((void)0)
+#define GPWE_PROFILE_FRAME() ((void)0)
+#endif
+
+#endif // !GPWE_PROFILER_HPP
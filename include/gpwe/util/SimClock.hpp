@@ -0,0 +1,84 @@
+#ifndef GPWE_SIMCLOCK_HPP
+#define GPWE_SIMCLOCK_HPP 1
+
+#include <chrono>
+
+#include "types.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief Fixed-timestep simulation clock.
+	 * Real frame time goes in, a whole number of fixed steps comes out. Steps
+	 * per frame are capped, so a hitch drops simulated time rather than
+	 * snowballing. Time is kept in integer nanoseconds so it doesn't drift
+	 * over long uptimes.
+	 */
+	class SimClock{
+		public:
+			using Duration = std::chrono::nanoseconds;
+
+			explicit SimClock(Duration step_ = Duration(1'000'000'000 / 120), Nat32 maxSteps_ = 4) noexcept
+				: m_step(step_), m_maxSteps(maxSteps_){}
+
+			Duration step() const noexcept{ return m_step; }
+			float stepSeconds() const noexcept{ return std::chrono::duration<float>(m_step).count(); }
+
+			void setStep(Duration step_) noexcept{
+				m_step = step_;
+				m_accum = Duration::zero();
+			}
+
+			// catch-up budget, most steps a single frame may run
+			Nat32 maxSteps() const noexcept{ return m_maxSteps; }
+			void setMaxSteps(Nat32 n) noexcept{ m_maxSteps = n; }
+
+			// feed elapsed real time, returns how many steps to simulate now
+			Nat32 advance(Duration elapsed) noexcept{
+				m_accum += elapsed;
+
+				auto steps = m_accum / m_step;
+
+				if(steps > m_maxSteps){
+					const auto dropped = m_step * (steps - m_maxSteps);
+					m_dropped += dropped;
+					m_accum -= dropped;
+					steps = m_maxSteps;
+				}
+
+				m_accum -= m_step * steps;
+				m_time += m_step * steps;
+				m_numSteps += steps;
+
+				return Nat32(steps);
+			}
+
+			// how far the frame is between the last step and the next, in [0, 1)
+			float alpha() const noexcept{
+				return float(double(m_accum.count()) / double(m_step.count()));
+			}
+
+			// simulated time so far
+			Duration time() const noexcept{ return m_time; }
+			double seconds() const noexcept{ return std::chrono::duration<double>(m_time).count(); }
+
+			Nat64 numSteps() const noexcept{ return m_numSteps; }
+
+			// real time discarded by the catch-up budget
+			Duration droppedTime() const noexcept{ return m_dropped; }
+
+			void reset() noexcept{
+				m_accum = m_time = m_dropped = Duration::zero();
+				m_numSteps = 0;
+			}
+
+		private:
+			Duration m_step;
+			Nat32 m_maxSteps;
+			Duration m_accum = Duration::zero();
+			Duration m_time = Duration::zero();
+			Duration m_dropped = Duration::zero();
+			Nat64 m_numSteps = 0;
+	};
+}
+
+#endif // !GPWE_SIMCLOCK_HPP
@@ -0,0 +1,97 @@
+#ifndef GPWE_SPSCRING_HPP
+#define GPWE_SPSCRING_HPP 1
+
+#include <atomic>
+#include <bit>
+#include <type_traits>
+
+#include "Allocator.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief Bounded lock-free ring, one producer thread and one consumer thread.
+	 * Storage is allocated once up front; pushing never blocks or allocates.
+	 */
+	template<typename T>
+	class SpscRing{
+		public:
+			static_assert(std::is_trivially_copyable_v<T>, "SpscRing elements must be trivially copyable");
+
+			// capacity is rounded up to a power of two
+			explicit SpscRing(std::size_t capacity_ = 1024)
+				: m_mask(std::bit_ceil(std::max<std::size_t>(capacity_, 2)) - 1)
+			{
+				m_items = reinterpret_cast<T*>(sys::alloc(sizeof(T) * (m_mask + 1)));
+			}
+
+			SpscRing(const SpscRing&) = delete;
+
+			~SpscRing(){ sys::free(m_items); }
+
+			SpscRing &operator=(const SpscRing&) = delete;
+
+			std::size_t capacity() const noexcept{ return m_mask + 1; }
+
+			std::size_t size() const noexcept{
+				return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+			}
+
+			bool empty() const noexcept{ return size() == 0; }
+
+			// producer only, false if the ring is full
+			bool tryPush(const T &val) noexcept{
+				const auto tail = m_tail.load(std::memory_order_relaxed);
+
+				if(tail - m_headCache > m_mask){
+					m_headCache = m_head.load(std::memory_order_acquire);
+					if(tail - m_headCache > m_mask) return false;
+				}
+
+				m_items[tail & m_mask] = val;
+				m_tail.store(tail + 1, std::memory_order_release);
+				return true;
+			}
+
+			// consumer only, false if the ring is empty
+			bool tryPop(T &ret) noexcept{
+				const auto head = m_head.load(std::memory_order_relaxed);
+
+				if(head == m_tailCache){
+					m_tailCache = m_tail.load(std::memory_order_acquire);
+					if(head == m_tailCache) return false;
+				}
+
+				ret = m_items[head & m_mask];
+				m_head.store(head + 1, std::memory_order_release);
+				return true;
+			}
+
+			// consumer only, pops everything available into f in order
+			template<typename F>
+			std::size_t drain(F &&f){
+				const auto head = m_head.load(std::memory_order_relaxed);
+				const auto tail = m_tail.load(std::memory_order_acquire);
+
+				for(auto i = head; i != tail; i++){
+					f(m_items[i & m_mask]);
+				}
+
+				m_head.store(tail, std::memory_order_release);
+				return tail - head;
+			}
+
+		private:
+			T *m_items;
+			std::size_t m_mask;
+
+			// producer and consumer state on separate cache lines
+			char m_pad0[64];
+			std::atomic<std::size_t> m_tail = 0;
+			std::size_t m_headCache = 0;
+			char m_pad1[64 - sizeof(std::size_t) * 2];
+			std::atomic<std::size_t> m_head = 0;
+			std::size_t m_tailCache = 0;
+	};
+}
+
+#endif // !GPWE_SPSCRING_HPP
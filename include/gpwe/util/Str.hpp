@@ -1,6 +1,12 @@
 #ifndef GPWE_STRING_HPP
 #define GPWE_STRING_HPP 1
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <locale>
+#include <span>
+#include <stdexcept>
 #include <string>
 
 #include "fmt/format.h"
@@ -8,21 +14,151 @@
 #include "Allocator.hpp"
 
 namespace gpwe{
-	using Str = std::basic_string<char, std::char_traits<char>, Allocator<char>>;
+	template<typename Res = void>
+	using BasicStr = std::basic_string<char, std::char_traits<char>, Allocator<char, Res>>;
+
+	using Str = BasicStr<>;
 	using StrView = std::string_view;
 
+	using FrameStr = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
 	template<typename String>
 	inline StrView strView(const String &str_){ return str_; }
 
 	template<meta::CStr Str_>
 	inline StrView strView(){ return StrView(Str_.str, Str_.length); }
 
-	inline Str vformat(Allocator<Str::value_type> alloc, fmt::string_view fmtStr, fmt::format_args args){
-		using MemoryBuffer =
-		  fmt::basic_memory_buffer<Str::value_type, fmt::inline_buffer_size, Allocator<Str::value_type>>;
+	/**
+	 * @brief Locale used for 'L' format specs, built on first use.
+	 * Falls back to the classic locale if en_US.UTF-8 isn't installed.
+	 */
+	inline const std::locale &formatLocale(){
+		static const std::locale ret = []{
+			try{
+				return std::locale("en_US.UTF-8");
+			}
+			catch(const std::runtime_error&){
+				return std::locale::classic();
+			}
+		}();
+
+		return ret;
+	}
+
+	namespace detail{
+		// formatting happens here first, only lines past inline_buffer_size hit the heap
+		using FormatBuffer = fmt::basic_memory_buffer<char, fmt::inline_buffer_size, Allocator<char>>;
+
+		// writes up to n chars then drops the rest, fmt has no vformat_to_n taking a locale
+		struct TruncatingIterator{
+			using iterator_category = std::output_iterator_tag;
+			using value_type = void;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = void;
+
+			char *out;
+			std::size_t n, written = 0;
+
+			TruncatingIterator &operator*() noexcept{ return *this; }
+			TruncatingIterator &operator++() noexcept{ return *this; }
+			TruncatingIterator &operator++(int) noexcept{ return *this; }
+
+			TruncatingIterator &operator=(char c) noexcept{
+				if(written < n) out[written] = c;
+				++written;
+				return *this;
+			}
+		};
+
+		struct FormatCheck{
+			bool valid = true;
+			bool manual = false; // uses {0} style indices
+			Nat32 numArgs = 0;
+		};
+
+		constexpr bool isFormatDigit(char c) noexcept{ return c >= '0' && c <= '9'; }
+
+		// arg id after a '{', at \p i on return; named args aren't supported
+		constexpr bool checkFormatArgId(const char *str, std::size_t n, std::size_t &i, FormatCheck &check, Nat32 &nextAuto) noexcept{
+			Nat32 idx;
+
+			if(i < n && isFormatDigit(str[i])){
+				idx = 0;
+				while(i < n && isFormatDigit(str[i])) idx = idx * 10 + Nat32(str[i++] - '0');
+				check.manual = true;
+			}
+			else if(i < n && (str[i] == ':' || str[i] == '}')){
+				idx = nextAuto++;
+			}
+			else{
+				return false;
+			}
 
-		MemoryBuffer buf(alloc);
-		fmt::vformat_to(std::back_inserter(buf), std::locale("en_US.UTF-8"), fmtStr, args);
+			check.numArgs = std::max(check.numArgs, idx + 1);
+			return true;
+		}
+
+		constexpr FormatCheck checkFormat(const char *str, std::size_t n) noexcept{
+			FormatCheck ret;
+			Nat32 nextAuto = 0;
+
+			for(std::size_t i = 0; i < n; i++){
+				if(str[i] == '}'){
+					if(i + 1 < n && str[i + 1] == '}'){ ++i; continue; }
+					ret.valid = false;
+					return ret;
+				}
+
+				if(str[i] != '{') continue;
+
+				if(i + 1 < n && str[i + 1] == '{'){ ++i; continue; }
+
+				++i;
+
+				if(!checkFormatArgId(str, n, i, ret, nextAuto)){
+					ret.valid = false;
+					return ret;
+				}
+
+				// format spec, may hold nested {} for dynamic width and precision
+				while(i < n && str[i] != '}'){
+					if(str[i++] != '{') continue;
+
+					if(!checkFormatArgId(str, n, i, ret, nextAuto) || i >= n || str[i] != '}'){
+						ret.valid = false;
+						return ret;
+					}
+
+					++i;
+				}
+
+				if(i >= n){
+					ret.valid = false;
+					return ret;
+				}
+			}
+
+			if(ret.manual && nextAuto > 0){
+				ret.valid = false;
+			}
+
+			return ret;
+		}
+
+		template<meta::CStr Fmt, typename ... Args>
+		constexpr bool checkFormatArgs() noexcept{
+			constexpr auto check = checkFormat(Fmt.str, Fmt.length);
+			static_assert(check.valid, "Malformed format string");
+			static_assert(check.manual || check.numArgs == sizeof...(Args), "Format string and argument count don't match");
+			static_assert(!check.manual || check.numArgs <= sizeof...(Args), "Format string refers to a missing argument");
+			return true;
+		}
+	}
+
+	inline Str vformat(Allocator<Str::value_type> alloc, fmt::string_view fmtStr, fmt::format_args args){
+		detail::FormatBuffer buf(alloc);
+		fmt::vformat_to(std::back_inserter(buf), formatLocale(), fmtStr, args);
 		return Str(buf.data(), buf.size(), alloc);
 	}
 
@@ -35,6 +171,81 @@ namespace gpwe{
 	inline Str format(fmt::string_view fmtStr, const Args&... args){
 		return format(Allocator<Str::value_type>{}, fmtStr, args...);
 	}
+
+	/**
+	 * @brief Format into a fixed buffer without allocating.
+	 * Output that doesn't fit is cut off. The result is always null terminated
+	 * and views the written part of \p out.
+	 */
+	inline StrView vformatTo(std::span<char> out, fmt::string_view fmtStr, fmt::format_args args){
+		if(out.empty()) return {};
+
+		// straight into out, whatever the length of the whole output
+		const auto res = fmt::vformat_to(detail::TruncatingIterator{ out.data(), out.size() - 1 }, formatLocale(), fmtStr, args);
+
+		const auto n = std::min(res.written, out.size() - 1);
+		out[n] = '\0';
+		return StrView(out.data(), n);
+	}
+
+	// append to any string, growing it at most once
+	template<typename Traits, typename Alloc>
+	inline StrView vformatTo(std::basic_string<char, Traits, Alloc> &out, fmt::string_view fmtStr, fmt::format_args args){
+		detail::FormatBuffer buf;
+		fmt::vformat_to(std::back_inserter(buf), formatLocale(), fmtStr, args);
+
+		const auto start = out.size();
+		out.append(buf.data(), buf.size());
+		return StrView(out.data() + start, buf.size());
+	}
+
+	template<typename ... Args>
+	inline StrView formatTo(std::span<char> out, fmt::string_view fmtStr, const Args&... args){
+		return vformatTo(out, fmtStr, fmt::make_format_args(args...));
+	}
+
+	template<typename Traits, typename Alloc, typename ... Args>
+	inline StrView formatTo(std::basic_string<char, Traits, Alloc> &out, fmt::string_view fmtStr, const Args&... args){
+		return vformatTo(out, fmtStr, fmt::make_format_args(args...));
+	}
+
+	/**
+	 * @brief Format into the calling thread's scratch buffer.
+	 * The result stays valid until the next formatScratch on the same thread;
+	 * the buffer keeps its capacity, so this stops allocating once warm.
+	 */
+	inline StrView vformatScratch(fmt::string_view fmtStr, fmt::format_args args){
+		thread_local detail::FormatBuffer buf;
+
+		buf.clear();
+		fmt::vformat_to(std::back_inserter(buf), formatLocale(), fmtStr, args);
+		return StrView(buf.data(), buf.size());
+	}
+
+	template<typename ... Args>
+	inline StrView formatScratch(fmt::string_view fmtStr, const Args&... args){
+		return vformatScratch(fmtStr, fmt::make_format_args(args...));
+	}
+
+	// checked at compile time against the argument count, e.g. format<"{} {}">(a, b)
+
+	template<meta::CStr Fmt, typename ... Args>
+	inline Str format(const Args&... args){
+		static_assert(detail::checkFormatArgs<Fmt, Args...>());
+		return format(fmt::string_view(Fmt.str, Fmt.length), args...);
+	}
+
+	template<meta::CStr Fmt, typename Out, typename ... Args>
+	inline StrView formatTo(Out &&out, const Args&... args){
+		static_assert(detail::checkFormatArgs<Fmt, Args...>());
+		return formatTo(std::forward<Out>(out), fmt::string_view(Fmt.str, Fmt.length), args...);
+	}
+
+	template<meta::CStr Fmt, typename ... Args>
+	inline StrView formatScratch(const Args&... args){
+		static_assert(detail::checkFormatArgs<Fmt, Args...>());
+		return formatScratch(fmt::string_view(Fmt.str, Fmt.length), args...);
+	}
 }
 
 #endif // !GPWE_STRING_HPP
@@ -0,0 +1,263 @@
+#ifndef GPWE_TASK_HPP
+#define GPWE_TASK_HPP 1
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "gpwe/log.hpp"
+
+#include "Allocator.hpp"
+
+namespace gpwe{
+	class InvalidTaskError: public std::exception{
+		public:
+			const char *what() const noexcept override{ return "awaiting an empty task"; }
+	};
+
+	template<typename T = void>
+	class Task;
+
+	namespace detail{
+		/**
+		 * @brief Shared promise logic, frames come from sys::alloc.
+		 * A coroutine taking (std::allocator_arg_t, MemoryResource*, ...) as its
+		 * first parameters gets its frame from that resource instead.
+		 */
+		class TaskPromiseBase{
+			public:
+				static void *operator new(std::size_t n){
+					return frameAlloc(n, nullptr);
+				}
+
+				template<typename ... Args>
+				static void *operator new(std::size_t n, std::allocator_arg_t, MemoryResource *res, Args&&...){
+					return frameAlloc(n, res);
+				}
+
+				static void operator delete(void *ptr, std::size_t n) noexcept{
+					auto mem = reinterpret_cast<char*>(ptr) - frameHeaderSize;
+					auto res = *reinterpret_cast<MemoryResource**>(mem);
+
+					if(res) res->deallocate(mem, n + frameHeaderSize);
+					else sys::free(mem);
+				}
+
+				std::suspend_always initial_suspend() const noexcept{ return {}; }
+
+				struct FinalAwaiter{
+					bool await_ready() const noexcept{ return false; }
+
+					template<typename Promise>
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept{
+						auto &&promise = h.promise();
+
+						if(promise.m_continuation){
+							return promise.m_continuation;
+						}
+
+						if(promise.m_detached){
+							if(promise.m_exception){
+								logDetachedError(promise.m_exception);
+							}
+
+							h.destroy();
+						}
+
+						return std::noop_coroutine();
+					}
+
+					void await_resume() const noexcept{}
+				};
+
+				FinalAwaiter final_suspend() const noexcept{ return {}; }
+
+				void unhandled_exception() noexcept{
+					m_exception = std::current_exception();
+				}
+
+			protected:
+				static constexpr std::size_t frameHeaderSize = alignof(std::max_align_t);
+
+				static void *frameAlloc(std::size_t n, MemoryResource *res){
+					auto mem = res ? res->allocate(n + frameHeaderSize) : sys::alloc(n + frameHeaderSize);
+					*reinterpret_cast<MemoryResource**>(mem) = res;
+					return reinterpret_cast<char*>(mem) + frameHeaderSize;
+				}
+
+				static void logDetachedError(std::exception_ptr err) noexcept{
+					try{
+						std::rethrow_exception(err);
+					}
+					catch(const std::exception &exc){
+						log::errorLn("Uncaught exception in detached task: {}", exc.what());
+					}
+					catch(...){
+						log::errorLn("Uncaught exception in detached task");
+					}
+				}
+
+				void rethrowIfFailed() const{
+					if(m_exception) std::rethrow_exception(m_exception);
+				}
+
+				std::coroutine_handle<> m_continuation;
+				std::exception_ptr m_exception;
+				bool m_detached = false;
+
+				template<typename>
+				friend class gpwe::Task;
+		};
+
+		template<typename T>
+		class TaskPromise: public TaskPromiseBase{
+			public:
+				Task<T> get_return_object() noexcept;
+
+				template<typename U>
+				void return_value(U &&val){
+					m_value.emplace(std::forward<U>(val));
+				}
+
+				T result(){
+					rethrowIfFailed();
+					return std::move(*m_value);
+				}
+
+			private:
+				std::optional<T> m_value;
+		};
+
+		template<>
+		class TaskPromise<void>: public TaskPromiseBase{
+			public:
+				Task<void> get_return_object() noexcept;
+
+				void return_void() const noexcept{}
+
+				void result(){
+					rethrowIfFailed();
+				}
+		};
+	}
+
+	/**
+	 * @brief Lazily started coroutine producing a T.
+	 * Runs when first awaited, or when detached. Awaiting a task resumes the
+	 * awaiting coroutine on whatever thread the task finished on; hop threads
+	 * with co_await resumeOn(queue).
+	 */
+	template<typename T>
+	class Task{
+		public:
+			using promise_type = detail::TaskPromise<T>;
+			using Handle = std::coroutine_handle<promise_type>;
+
+			Task() noexcept = default;
+
+			Task(Task &&other) noexcept
+				: m_handle(std::exchange(other.m_handle, nullptr)){}
+
+			Task(const Task&) = delete;
+
+			~Task(){
+				if(m_handle) m_handle.destroy();
+			}
+
+			Task &operator=(Task &&other) noexcept{
+				if(&other != this){
+					if(m_handle) m_handle.destroy();
+					m_handle = std::exchange(other.m_handle, nullptr);
+				}
+
+				return *this;
+			}
+
+			Task &operator=(const Task&) = delete;
+
+			bool valid() const noexcept{ return bool(m_handle); }
+			bool done() const noexcept{ return m_handle && m_handle.done(); }
+
+			/**
+			 * @brief Start the task without anyone awaiting it.
+			 * The frame frees itself when finished, uncaught exceptions are logged.
+			 */
+			void detach(){
+				if(!m_handle) return;
+
+				auto handle = std::exchange(m_handle, nullptr);
+				handle.promise().m_detached = true;
+				handle.resume();
+			}
+
+			// throws InvalidTaskError for a default or moved from task
+			auto operator co_await(){
+				if(!m_handle) throw InvalidTaskError{};
+
+				struct Awaiter{
+					Handle handle;
+
+					bool await_ready() const noexcept{ return handle.done(); }
+
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept{
+						handle.promise().m_continuation = awaiting;
+						return handle;
+					}
+
+					T await_resume(){ return handle.promise().result(); }
+				};
+
+				return Awaiter{ m_handle };
+			}
+
+		private:
+			explicit Task(Handle handle_) noexcept
+				: m_handle(handle_){}
+
+			Handle m_handle;
+
+			friend promise_type;
+	};
+
+	template<typename T>
+	inline Task<T> detail::TaskPromise<T>::get_return_object() noexcept{
+		return Task<T>(Task<T>::Handle::from_promise(*this));
+	}
+
+	inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept{
+		return Task<void>(Task<void>::Handle::from_promise(*this));
+	}
+
+	/**
+	 * @brief Awaitable that continues the coroutine from \p queue.
+	 * Works with anything taking an Fn<void()> through post (WorkQueue,
+	 * CommandQueue) or run (JobSystem).
+	 */
+	template<typename Queue>
+	auto resumeOn(Queue &queue) noexcept{
+		struct Awaiter{
+			Queue &queue;
+
+			bool await_ready() const noexcept{ return false; }
+
+			void await_suspend(std::coroutine_handle<> h){
+				auto resume = [h]{ h.resume(); };
+
+				if constexpr(requires{ queue.post(resume); }){
+					queue.post(resume);
+				}
+				else{
+					queue.run(resume);
+				}
+			}
+
+			void await_resume() const noexcept{}
+		};
+
+		return Awaiter{ queue };
+	}
+}
+
+#endif // !GPWE_TASK_HPP
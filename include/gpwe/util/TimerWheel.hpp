@@ -0,0 +1,131 @@
+#ifndef GPWE_TIMERWHEEL_HPP
+#define GPWE_TIMERWHEEL_HPP 1
+
+#include <chrono>
+#include <mutex>
+
+#include "Fn.hpp"
+#include "Vector.hpp"
+#include "types.hpp"
+
+namespace gpwe{
+	class JobSystem;
+
+	enum class TimerDispatch: Nat8{
+		caller, // on the thread calling TimerWheel::advance
+		jobs // on job system workers, advance waits for them
+	};
+
+	/**
+	 * @brief Hierarchical timing wheel for delayed and periodic callbacks.
+	 * Four levels of 256 slots cover 2^32 ticks. Scheduling and cancelling are
+	 * O(1), and advancing only touches timers that are due or cascading down a
+	 * level. Timers are named by generation checked handles, so cancelling a
+	 * timer that already fired is harmless. Thread safe; callbacks may schedule
+	 * and cancel timers.
+	 */
+	class TimerWheel{
+		public:
+			using Duration = std::chrono::nanoseconds;
+
+			class Handle{
+				public:
+					Handle() noexcept = default;
+
+					explicit operator bool() const noexcept{ return m_gen != 0; }
+
+					bool operator==(const Handle&) const noexcept = default;
+
+				private:
+					Handle(Nat32 idx_, Nat32 gen_) noexcept
+						: m_idx(idx_), m_gen(gen_){}
+
+					Nat32 m_idx = 0, m_gen = 0;
+
+					friend class TimerWheel;
+			};
+
+			explicit TimerWheel(Duration resolution_ = std::chrono::milliseconds(1));
+
+			TimerWheel(const TimerWheel&) = delete;
+
+			TimerWheel &operator=(const TimerWheel&) = delete;
+
+			Duration resolution() const noexcept{ return m_resolution; }
+
+			// needed for TimerDispatch::jobs, without one those timers run on the caller
+			void setJobSystem(JobSystem *jobs) noexcept{ m_jobs = jobs; }
+
+			// call fn once, delay from now
+			Handle after(Duration delay, Fn<void()> fn, TimerDispatch dispatch = TimerDispatch::caller);
+
+			// call fn every period, first time one period from now
+			Handle every(Duration period, Fn<void()> fn, TimerDispatch dispatch = TimerDispatch::caller);
+
+			// false if the timer already fired or was cancelled
+			bool cancel(Handle handle);
+
+			bool pending(Handle handle) const;
+
+			std::size_t numPending() const;
+
+			// move time forward and run every timer that came due
+			void advance(Duration elapsed);
+
+		private:
+			static constexpr Nat32 levelBits = 8;
+			static constexpr Nat32 numLevels = 4;
+			static constexpr Nat32 numSlots = 1u << levelBits;
+			static constexpr Nat32 slotMask = numSlots - 1;
+			static constexpr Nat32 nil = ~Nat32(0);
+
+			enum class State: Nat8{
+				free, scheduled, running, cancelled
+			};
+
+			struct Node{
+				Fn<void()> fn;
+				Nat64 expiry;
+				Nat64 period;
+				Nat32 gen;
+				Nat32 prev, next;
+				Nat16 slot;
+				State state;
+				TimerDispatch dispatch;
+			};
+
+			struct Due{
+				Nat32 idx;
+				TimerDispatch dispatch;
+				Fn<void()> fn;
+			};
+
+			Handle schedule(Nat64 delayTicks, Nat64 period, Fn<void()> fn, TimerDispatch dispatch);
+
+			Node *lookup(Handle handle) noexcept;
+			const Node *lookup(Handle handle) const noexcept;
+
+			Nat64 toTicks(Duration d) const noexcept;
+
+			void link(Nat32 idx);
+			void unlink(Nat32 idx) noexcept;
+			void release(Nat32 idx) noexcept;
+			void cascade(Nat32 level);
+			void collect(Vector<Due> &due);
+
+			mutable std::mutex m_mut;
+			Duration m_resolution;
+			Duration m_accum = Duration::zero();
+			Nat64 m_now = 0;
+			JobSystem *m_jobs = nullptr;
+
+			Vector<Node> m_nodes;
+			Nat32 m_freeHead = nil;
+			std::size_t m_numPending = 0;
+			Nat32 m_slots[numLevels][numSlots];
+
+			Vector<Due> m_due;
+	};
+}
+
+#endif // !GPWE_TIMERWHEEL_HPP
@@ -6,8 +6,11 @@
 #include "Allocator.hpp"
 
 namespace gpwe{
+	template<typename T, typename Res = void>
+	using Vector = std::vector<T, Allocator<T, Res>>;
+
 	template<typename T>
-	using Vector = std::vector<T, Allocator<T>>;
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
 }
 
 #endif // !GPWE_VECTOR_HPP
@@ -1,64 +1,111 @@
 #ifndef GPWE_WORKQUEUE_HPP
 #define GPWE_WORKQUEUE_HPP 1
 
-#include <future>
+#include <algorithm>
+#include <iterator>
 #include <mutex>
 
-#include "List.hpp"
+#include "Vector.hpp"
+#include "Future.hpp"
 #include "Fn.hpp"
 
 namespace gpwe{
 	class WorkQueue{
 		public:
 			~WorkQueue(){
-				doWork();
+				// including whatever the last tasks post
+				while(doWork()){}
 			}
 
 			template<typename F>
 			auto emplace(F f){
-				using Result = std::result_of_t<F>;
+				using Result = std::invoke_result_t<F&>;
 
-				std::promise<Result> prom;
-				auto fut = prom.get_future();
+				Promise<Result> prom;
+				auto fut = prom.future();
 
-				std::lock_guard lock(m_mut);
-
-				m_tasks.emplace_back([fn{std::move(f)}, p{std::move(prom)}]{
-					if constexpr(std::is_same_v<void, Result>){
-						fn();
-						p.set_value();
-					}
-					else{
-						p.set_value(fn());
-					}
+				post([fn{std::move(f)}, p{std::move(prom)}]() mutable{
+					detail::fulfill(p, fn);
 				});
 
 				return fut;
 			}
 
-			std::size_t doWork(std::size_t n = SIZE_MAX){
+			/**
+			 * @brief Queue f without a future to wait on.
+			 * Doesn't allocate once the queue has grown to its working size, as long
+			 * as f fits inline in an Fn.
+			 */
+			void post(Fn<void()> f){
 				std::lock_guard lock(m_mut);
+				m_tasks.emplace_back(std::move(f));
+			}
+
+			/**
+			 * @brief Run up to n of the tasks queued when called, oldest first.
+			 * Tasks posted meanwhile wait for the next call. If a task throws, the
+			 * rest of its batch goes back to the front of the queue before the
+			 * exception propagates.
+			 */
+			std::size_t doWork(std::size_t n = SIZE_MAX){
+				constexpr std::size_t batchSize = 16;
 
-				if(m_tasks.empty()) return 0;
+				Fn<void()> batch[batchSize];
+				std::size_t numDone = 0;
 
-				n = std::min(n, m_tasks.size());
+				{
+					std::lock_guard lock(m_mut);
+					n = std::min(n, m_tasks.size() - m_head);
+				}
 
-				auto it = m_tasks.begin();
+				// take tasks in small batches and run them unlocked, so they can queue more work
+				while(numDone < n){
+					std::size_t numTaken = 0;
+
+					{
+						std::lock_guard lock(m_mut);
+
+						while(numTaken < batchSize && (numDone + numTaken) < n && m_head < m_tasks.size()){
+							batch[numTaken++] = std::move(m_tasks[m_head++]);
+						}
+
+						if(m_head == m_tasks.size()){
+							m_tasks.clear();
+							m_head = 0;
+						}
+						else if(m_head >= 64 && m_head > (m_tasks.size() / 2)){
+							// never fully drained, don't let the front grow forever
+							m_tasks.erase(m_tasks.begin(), m_tasks.begin() + m_head);
+							m_head = 0;
+						}
+					}
 
-				for(std::size_t i = 0; i < n && it != m_tasks.end(); i++){
-					auto &&f = *it;
-					f();
-					auto next = it;
-					++next;
-					m_tasks.erase(it);
-					it = next;
+					if(!numTaken) break;
+
+					for(std::size_t i = 0; i < numTaken; i++){
+						try{
+							batch[i]();
+						}
+						catch(...){
+							std::lock_guard lock(m_mut);
+							m_tasks.insert(
+								m_tasks.begin() + m_head,
+								std::make_move_iterator(batch + i + 1),
+								std::make_move_iterator(batch + numTaken)
+							);
+							throw;
+						}
+
+						batch[i] = nullptr;
+					}
+
+					numDone += numTaken;
 				}
 
-				return n;
+				return numDone;
 			}
 
-			template<typename F>
-			std::size_t doWorkOr(F &&f, std::size_t n = SIZE_MAX){
+			std::size_t doWorkOr(FnRef<void()> f, std::size_t n = SIZE_MAX){
 				auto ret = doWork(n);
 				if(!ret){
 					f();
@@ -69,7 +116,8 @@ namespace gpwe{
 
 		private:
 			std::mutex m_mut;
-			List<Fn<void()>> m_tasks;
+			Vector<Fn<void()>> m_tasks;
+			std::size_t m_head = 0;
 	};
 }
 
@@ -59,6 +59,11 @@ namespace gpwe::world{
 	};
 }
 
+namespace gpwe{
+	template<> inline constexpr bool poolManaged<world::Block> = true;
+	template<> inline constexpr bool poolManaged<world::Entity> = true;
+}
+
 #define GPWE_WORLD_PLUGIN(type, name, author, major, minor, patch)\
 	GPWE_PLUGIN(world, type, name, author, major, minor, patch)
 
@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <cstring>
+
+#include "gpwe/BinaryLog.hpp"
+
+using namespace gpwe;
+
+namespace {
+	void usage(const char *argv0){
+		std::fprintf(stderr, "Usage: %s [--time] [--kind] FILE\n", argv0);
+		std::fprintf(stderr, "Decodes a binary log written by gpwe::log::BinaryLog to stdout\n");
+	}
+
+	const char *kindName(Nat8 kind){
+		switch(log::Kind(kind)){
+			case log::Kind::info: return "info";
+			case log::Kind::warning: return "warning";
+			case log::Kind::error: return "error";
+			default: return "?";
+		}
+	}
+
+	template<typename T>
+	bool readRaw(std::FILE *file, T &out){
+		return std::fread(&out, sizeof(T), 1, file) == 1;
+	}
+}
+
+int main(int argc, char *argv[]){
+	bool showTime = false, showKind = false;
+	const char *path = nullptr;
+
+	for(int i = 1; i < argc; i++){
+		const StrView arg = argv[i];
+
+		if(arg == "--time") showTime = true;
+		else if(arg == "--kind") showKind = true;
+		else if(arg == "--help" || arg == "-h"){
+			usage(argv[0]);
+			return 0;
+		}
+		else if(!path) path = argv[i];
+		else{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if(!path){
+		usage(argv[0]);
+		return 1;
+	}
+
+	auto file = std::fopen(path, "rb");
+	if(!file){
+		std::fprintf(stderr, "Could not open '%s'\n", path);
+		return 1;
+	}
+
+	char magic[sizeof(log::BinaryLog::fileMagic)];
+	Nat32 version = 0;
+
+	if(
+		std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+		std::memcmp(magic, log::BinaryLog::fileMagic, sizeof(magic)) != 0 ||
+		!readRaw(file, version)
+	){
+		std::fprintf(stderr, "'%s' is not a binary log\n", path);
+		std::fclose(file);
+		return 1;
+	}
+
+	if(version != log::BinaryLog::fileVersion){
+		std::fprintf(stderr, "'%s' is version %u, only version %u can be decoded\n", path, version, log::BinaryLog::fileVersion);
+		std::fclose(file);
+		return 1;
+	}
+
+	Vector<Str> sites;
+	Vector<Nat64> record; // 8 byte aligned storage for one record
+	Str line;
+	int ret = 0;
+	bool truncated = false;
+
+	log::BinaryLog::Chunk chunk;
+
+	while(readRaw(file, chunk)){
+		if(chunk == log::BinaryLog::Chunk::site){
+			Nat32 id, len;
+
+			if(!readRaw(file, id) || !readRaw(file, len)){
+				truncated = true;
+				break;
+			}
+
+			if(id >= sites.size()) sites.resize(id + 1);
+
+			sites[id].resize(len);
+
+			if(std::fread(sites[id].data(), 1, len, file) != len){
+				truncated = true;
+				break;
+			}
+		}
+		else if(chunk == log::BinaryLog::Chunk::record){
+			log::BinaryRecord header;
+
+			if(!readRaw(file, header) || header.size < sizeof(header)){
+				truncated = true;
+				break;
+			}
+
+			record.resize((header.size + 7) / 8);
+			std::memcpy(record.data(), &header, sizeof(header));
+
+			const auto rest = header.size - sizeof(header);
+			if(std::fread(reinterpret_cast<char*>(record.data()) + sizeof(header), 1, rest, file) != rest){
+				truncated = true;
+				break;
+			}
+
+			if(header.site >= sites.size()){
+				std::fprintf(stderr, "Record refers to unknown format %u\n", header.site);
+				ret = 1;
+				continue;
+			}
+
+			line.clear();
+
+			if(showTime){
+				line += fmt::format("[{}.{:09}] ", header.time / 1000000000, header.time % 1000000000);
+			}
+
+			if(showKind){
+				line += fmt::format("[{}] ", kindName(header.kind));
+			}
+
+			if(!log::decodeBinaryRecord(line, sites[header.site].c_str(), reinterpret_cast<const log::BinaryRecord*>(record.data()))){
+				line += "<malformed record for '";
+				line += sites[header.site];
+				line += "'>";
+				ret = 1;
+			}
+
+			line += '\n';
+			std::fwrite(line.data(), 1, line.size(), stdout);
+		}
+		else{
+			std::fprintf(stderr, "Unknown chunk %u, the file is corrupt\n", unsigned(chunk));
+			ret = 1;
+			break;
+		}
+	}
+
+	if(truncated){
+		std::fprintf(stderr, "'%s' ends in the middle of a chunk\n", path);
+		ret = 1;
+	}
+
+	std::fclose(file);
+	return ret;
+}
@@ -145,16 +145,16 @@ World::~World(){
 }
 
 void World::update(float dt){
-	const float physicsDt = 1.f/120.f;
-	m_world->stepSimulation(dt, 100, physicsDt);
+	// dt is already the engine's fixed step, so take exactly one substep
+	m_world->stepSimulation(dt, 1, dt);
 }
 
 UniquePtr<physics::BodyShape> World::doCreateBodyShape(const gpwe::Shape *shape){
 	if(auto field = dynamic_cast<const gpwe::HeightMapShape*>(shape)){
-		return makeUnique<BodyShape>(field);
+		return makeManaged<BodyShape>(field);
 	}
 	else if(auto mesh = dynamic_cast<const gpwe::VertexShape*>(shape)){
-		return makeUnique<BodyShape>(mesh);
+		return makeManaged<BodyShape>(mesh);
 	}
 	else{
 		log::errorLn("Bullet3 Physics Error: Only VertexShape and HeightMapShape currently supported");
@@ -168,5 +168,5 @@ UniquePtr<physics::Body> World::doCreateBody(const physics::BodyShape *bodyShape
 		return nullptr;
 	}
 
-	return makeUnique<RigidBody>(m_world.get(), derived, mass);
+	return makeManaged<RigidBody>(m_world.get(), derived, mass);
 }
@@ -32,14 +32,6 @@ inline Iter binary_find(Iter begin, Iter end, T val){
 
 GPWE_RENDER_PLUGIN(gpwe::RendererGL43, "OpenGL 4.3", "RamblingMad", 0, 0, 0)
 
-struct DrawElementsIndirectCommand{
-	GLuint count;
-	GLuint primCount;
-	GLuint firstIndex;
-	GLuint baseVertex;
-	GLuint baseInstance;
-};
-
 namespace {
 	inline GLenum dataTypeToGL(render::DataType type){
 		using Type = render::DataType;
@@ -78,14 +70,13 @@ RenderGroupGL43::RenderGroupGL43(
 
 	glCreateBuffers(std::size(m_bufs), m_bufs);
 
-	Vector<DrawElementsIndirectCommand> cmds;
-	cmds.resize(numShapes);
+	m_cmds.resize(numShapes);
 
 	std::uint32_t totalNumPoints = 0, totalNumIndices = 0;
 
 	for(std::uint32_t i = 0; i < numShapes; i++){
 		auto shape = shapes[i];
-		auto &cmd = cmds[i];
+		auto &cmd = m_cmds[i];
 
 		cmd.count = shape->numIndices();
 		cmd.primCount = 0; // start with no instances/
@@ -97,9 +88,9 @@ RenderGroupGL43::RenderGroupGL43(
 		totalNumIndices += shape->numIndices();
 	}
 
-	Vector<Vec3> verts, norms;
-	Vector<Vec2> uvs;
-	Vector<std::uint32_t> indices;
+	FrameVector<Vec3> verts, norms;
+	FrameVector<Vec2> uvs;
+	FrameVector<std::uint32_t> indices;
 
 	verts.reserve(totalNumPoints);
 	norms.reserve(totalNumPoints);
@@ -123,22 +114,12 @@ RenderGroupGL43::RenderGroupGL43(
 
 	glNamedBufferStorage(m_bufs[3], sizeof(std::uint32_t) * totalNumIndices, indices.data(), GL_MAP_READ_BIT);
 
-	glNamedBufferStorage(m_bufs[4], sizeof(DrawElementsIndirectCommand) * numShapes, cmds.data(), GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT);
-
-	m_cmdPtr = glMapNamedBufferRange(
-		m_bufs[4],
-		0, sizeof(DrawElementsIndirectCommand) * numShapes,
-		GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT
-	);
+	// both rewritten by upload on the render thread, the driver keeps frames in flight intact
+	glNamedBufferStorage(m_bufs[4], sizeof(DrawElementsIndirectCommand) * numShapes, m_cmds.data(), GL_DYNAMIC_STORAGE_BIT);
 
 	if(totalAttribSize > 0){
-		glNamedBufferStorage(m_bufs[5], totalAttribSize * numAlloced, nullptr, GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-
-		m_dataPtr = glMapNamedBufferRange(
-			m_bufs[5],
-			0, totalAttribSize * numAlloced,
-			GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
-		);
+		glNamedBufferStorage(m_bufs[5], totalAttribSize * numAlloced, nullptr, GL_DYNAMIC_STORAGE_BIT);
+		m_data.reserve(totalAttribSize * numAlloced);
 	}
 
 	glCreateVertexArrays(1, &m_vao);
@@ -193,75 +174,63 @@ void RenderGroupGL43::draw() const noexcept{
 	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, m_numShapes, sizeof(DrawElementsIndirectCommand));
 }
 
-void *RenderGroupGL43::dataPtr(std::uint32_t idx){
-	if(idx >= numManaged<render::Instance>()) return nullptr;
-	return reinterpret_cast<char*>(m_dataPtr) + (instanceDataSize() * idx);
-}
-
-UniquePtr<render::Instance> RenderGroupGL43::doCreateInstance(){
-	std::size_t totalAttribSize = instanceDataSize();
-
-	if(totalAttribSize > 0 && numManaged<render::Instance>() == m_numAllocated){
-		auto newAlloced = m_numAllocated * 2;
-
-		GLuint newAttribBuf;
-		glCreateBuffers(1, &newAttribBuf);
+void RenderGroupGL43::extract(std::uint32_t slot){
+	const auto numInstances = std::uint32_t(numManaged<render::Instance>());
 
-		glNamedBufferStorage(
-			newAttribBuf,
-			totalAttribSize * newAlloced,
-			nullptr,
-			GL_MAP_READ_BIT | GL_MAP_WRITE_BIT |
-			GL_MAP_PERSISTENT_BIT |
-			GL_MAP_COHERENT_BIT
-		);
-
-		glCopyNamedBufferSubData(
-			m_bufs[5], newAttribBuf,
-			0, 0,
-			m_numAllocated * totalAttribSize
-		);
-
-		auto oldBuf = m_bufs[5];
-
-		m_bufs[5] = newAttribBuf;
-
-		m_dataPtr = glMapNamedBufferRange(
-			m_bufs[5],
-			0, totalAttribSize * newAlloced,
-			GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
-		);
-
-		m_numAllocated = newAlloced;
+	// keeps its capacity, so only allocates while the group grows
+	auto &&dst = m_slots[slot];
+	dst.data.assign(m_data.begin(), m_data.begin() + (instanceDataSize() * numInstances));
+	dst.numInstances = numInstances;
+}
 
-		glVertexArrayVertexBuffer(m_vao, 3, m_bufs[5], 0, totalAttribSize);
-		glVertexArrayBindingDivisor(m_vao, 3, 1);
+void RenderGroupGL43::upload(const render::FrameSnapshot *snap){
+	if(snap){
+		auto &&slot = m_slots[snap->slot];
+		uploadInstances(slot.data.data(), slot.numInstances);
+	}
+	else{
+		uploadInstances(m_data.data(), std::uint32_t(numManaged<render::Instance>()));
+	}
+}
 
-		std::uint32_t curAttrOff = 0;
+void RenderGroupGL43::uploadInstances(const char *data, std::uint32_t numInstances){
+	const auto totalAttribSize = instanceDataSize();
 
-		for(GLuint i = 0; i < instanceDataInfo().size(); i++){
-			auto &&info = instanceDataInfo()[i];
+	if(totalAttribSize > 0 && numInstances > 0){
+		if(numInstances > m_numAllocated){
+			while(m_numAllocated < numInstances){
+				m_numAllocated *= 2;
+			}
 
-			GLuint attribIdx = 3 + i;
+			// every upload is complete, so nothing to carry over from the old buffer
+			glDeleteBuffers(1, &m_bufs[5]);
+			glCreateBuffers(1, &m_bufs[5]);
+			glNamedBufferStorage(m_bufs[5], totalAttribSize * m_numAllocated, nullptr, GL_DYNAMIC_STORAGE_BIT);
+			glVertexArrayVertexBuffer(m_vao, 3, m_bufs[5], 0, totalAttribSize);
+		}
 
-			glEnableVertexArrayAttrib(m_vao, attribIdx);
-			glVertexArrayAttribBinding(m_vao, attribIdx, 3);
-			glVertexArrayAttribFormat(m_vao, attribIdx, render::dataTypeNumComponents(info.type()), dataTypeToGL(info.type()), GL_FALSE, curAttrOff);
+		glNamedBufferSubData(m_bufs[5], 0, totalAttribSize * numInstances, data);
+	}
 
-			curAttrOff += info.size();
+	if(numInstances != m_numUploaded){
+		for(auto &&cmd : m_cmds){
+			cmd.primCount = numInstances;
 		}
 
-		glDeleteBuffers(1, &oldBuf);
+		glNamedBufferSubData(m_bufs[4], 0, sizeof(DrawElementsIndirectCommand) * m_cmds.size(), m_cmds.data());
+		m_numUploaded = numInstances;
 	}
+}
 
-	auto cmds = reinterpret_cast<DrawElementsIndirectCommand*>(m_cmdPtr);
-	for(std::uint32_t i = 0; i < m_numShapes; i++){
-		auto cmd = cmds + i;
-		++cmd->primCount;
-		glFlushMappedNamedBufferRange(m_bufs[4], (i * sizeof(DrawElementsIndirectCommand)) + offsetof(DrawElementsIndirectCommand, primCount), sizeof(GLuint));
-	}
+void *RenderGroupGL43::dataPtr(std::uint32_t idx){
+	if(idx >= numManaged<render::Instance>()) return nullptr;
+	return m_data.data() + (instanceDataSize() * idx);
+}
 
-	return makeUnique<RenderInstanceGL43>(this, (std::uint32_t)numManaged<render::Instance>());
+UniquePtr<render::Instance> RenderGroupGL43::doCreateInstance(){
+	// no GL here, instances are made on the simulation side and picked up by upload
+	m_data.resize(instanceDataSize() * (numManaged<render::Instance>() + 1));
+	return makeManaged<RenderInstanceGL43>(this, (std::uint32_t)numManaged<render::Instance>());
 }
 
 void gpweGLMessageCB(
@@ -389,8 +358,12 @@ void RendererGL43::present(const Camera *cam) noexcept{
 
 	m_pipelineFullbright->use();
 
+	auto snap = snapshot();
+
 	for(auto &&group : managed<render::Group>()){
-		group->draw();
+		auto glGroup = static_cast<RenderGroupGL43*>(group.get());
+		glGroup->upload(snap);
+		glGroup->draw();
 	}
 
 	m_gbuffer->use(render::Framebuffer::Mode::read);
@@ -401,6 +374,12 @@ void RendererGL43::present(const Camera *cam) noexcept{
 	glBlitFramebuffer(0, 0, w, h, 0, 0, oldW, oldH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 }
 
+void RendererGL43::extract(render::FrameSnapshot &snap){
+	for(auto &&group : managed<render::Group>()){
+		static_cast<RenderGroupGL43*>(group.get())->extract(snap.slot);
+	}
+}
+
 UniquePtr<render::Group> RendererGL43::doCreateGroup(
 	std::uint32_t numShapes, const VertexShape **shapes,
 	Vector<render::InstanceData> instanceDataInfo
@@ -4,6 +4,19 @@
 #include "gpwe/render.hpp"
 
 namespace gpwe{
+	struct DrawElementsIndirectCommand{
+		std::uint32_t count;
+		std::uint32_t primCount;
+		std::uint32_t firstIndex;
+		std::uint32_t baseVertex;
+		std::uint32_t baseInstance;
+	};
+
+	/**
+	 * @brief Instance data is written to a plain CPU copy on the simulation side.
+	 * extract copies it into the snapshot's slot, and present uploads whichever
+	 * copy it is drawing, so the GL buffers are only touched on the render thread.
+	 */
 	class RenderGroupGL43: public render::Group{
 		public:
 			explicit RenderGroupGL43(
@@ -15,7 +28,11 @@ namespace gpwe{
 
 			void draw() const noexcept override;
 
-			std::uint32_t numInstances() const noexcept;
+			// copy the live instances into a snapshot slot
+			void extract(std::uint32_t slot);
+
+			// upload the instances a snapshot holds, or the live ones when null
+			void upload(const render::FrameSnapshot *snap);
 
 		protected:
 			void *dataPtr(std::uint32_t idx) override;
@@ -23,11 +40,20 @@ namespace gpwe{
 			UniquePtr<render::Instance> doCreateInstance() override;
 
 		private:
+			struct Slot{
+				Vector<char> data;
+				std::uint32_t numInstances = 0;
+			};
+
+			void uploadInstances(const char *data, std::uint32_t numInstances);
+
 			std::uint32_t m_numShapes;
 			std::uint32_t m_vao;
 			std::uint32_t m_bufs[6];
-			void *m_cmdPtr, *m_dataPtr;
-			std::uint32_t m_numAllocated = 0;
+			Vector<DrawElementsIndirectCommand> m_cmds;
+			Vector<char> m_data;
+			Slot m_slots[render::maxFrameSnapshots];
+			std::uint32_t m_numAllocated = 0, m_numUploaded = 0;
 
 			friend class RendererGL43;
 	};
@@ -102,6 +128,8 @@ namespace gpwe{
 
 			void present(const Camera *cam) noexcept override;
 
+			void extract(render::FrameSnapshot &snap) override;
+
 		protected:
 			UniquePtr<render::Group> doCreateGroup(
 				std::uint32_t numShapes, const VertexShape **shapes,
@@ -0,0 +1,178 @@
+#include <cstring>
+
+#include "gpwe/log.hpp"
+#include "gpwe/Camera.hpp"
+#include "gpwe/Shape.hpp"
+
+#include "RendererNull.hpp"
+
+using namespace gpwe;
+
+GPWE_RENDER_PLUGIN(gpwe::RendererNull, "Null Renderer", "RamblingMad", 0, 0, 0)
+
+namespace {
+	std::size_t textureKindSize(render::TextureKind kind) noexcept{
+		using Kind = render::TextureKind;
+
+		// color formats come in runs of r, rg, rgb, rgba per component type
+		if(kind < Kind::rgb10a2){
+			const auto idx = std::size_t(kind);
+			const auto run = idx / 4;
+			const std::size_t componentSize = run == 0 ? 1 : run <= 4 ? 2 : 4;
+			return componentSize * ((idx % 4) + 1);
+		}
+
+		switch(kind){
+			case Kind::d16: return 2;
+			case Kind::rgb10a2:
+			case Kind::d32:
+			case Kind::d32f:
+			case Kind::d24s8: return 4;
+			default: return 0;
+		}
+	}
+}
+
+RenderGroupNull::RenderGroupNull(
+	Vector<render::InstanceData> instDataInfo,
+	std::uint32_t numShapes, const VertexShape **shapes
+)
+	: render::Group(std::move(instDataInfo))
+	, m_numShapes(numShapes)
+{
+	std::uint32_t totalNumPoints = 0, totalNumIndices = 0;
+
+	for(std::uint32_t i = 0; i < numShapes; i++){
+		totalNumPoints += shapes[i]->numPoints();
+		totalNumIndices += shapes[i]->numIndices();
+	}
+
+	m_verts.reserve(totalNumPoints);
+	m_norms.reserve(totalNumPoints);
+	m_uvs.reserve(totalNumPoints);
+	m_indices.reserve(totalNumIndices);
+
+	for(std::uint32_t i = 0; i < numShapes; i++){
+		auto shape = shapes[i];
+
+		m_verts.insert(m_verts.end(), shape->vertices(), shape->vertices() + shape->numPoints());
+		m_norms.insert(m_norms.end(), shape->normals(), shape->normals() + shape->numPoints());
+		m_uvs.insert(m_uvs.end(), shape->uvs(), shape->uvs() + shape->numPoints());
+		m_indices.insert(m_indices.end(), shape->indices(), shape->indices() + shape->numIndices());
+	}
+
+	// same starting size as the GL renderer
+	m_numAllocated = 4;
+	m_data.resize(instanceDataSize() * m_numAllocated);
+}
+
+void RenderGroupNull::extract(std::uint32_t slot){
+	const auto numInstances = std::uint32_t(numManaged<render::Instance>());
+
+	auto &&dst = m_slots[slot];
+	dst.data.assign(m_data.begin(), m_data.begin() + (instanceDataSize() * numInstances));
+	dst.numInstances = numInstances;
+}
+
+NullDrawCommand RenderGroupNull::drawCommand(std::uint32_t idx, const render::FrameSnapshot *snap) const noexcept{
+	const auto numInstances = snap ? m_slots[snap->slot].numInstances : std::uint32_t(numManaged<render::Instance>());
+
+	const std::size_t vertexBytes =
+		m_verts.size() * sizeof(Vec3) +
+		m_norms.size() * sizeof(Vec3) +
+		m_uvs.size() * sizeof(Vec2);
+
+	const std::size_t indexBytes = m_indices.size() * sizeof(std::uint32_t);
+
+	return NullDrawCommand{
+		idx, m_numShapes, std::uint32_t(m_indices.size()), numInstances,
+		vertexBytes + indexBytes + (instanceDataSize() * numInstances)
+	};
+}
+
+void *RenderGroupNull::dataPtr(std::uint32_t idx){
+	if(idx >= numManaged<render::Instance>()) return nullptr;
+	return m_data.data() + (instanceDataSize() * idx);
+}
+
+UniquePtr<render::Instance> RenderGroupNull::doCreateInstance(){
+	// grows the way the GL renderer's instance buffer does
+	if(numManaged<render::Instance>() == m_numAllocated){
+		m_numAllocated *= 2;
+		m_data.resize(instanceDataSize() * m_numAllocated);
+	}
+
+	return makeManaged<RenderInstanceNull>(this, (std::uint32_t)numManaged<render::Instance>());
+}
+
+RenderTextureNull::RenderTextureNull(std::uint16_t w, std::uint16_t h, Kind kind_, const void *pixels)
+	: m_w(w), m_h(h), m_kind(kind_)
+{
+	if(pixels){
+		m_pixels.resize(std::size_t(w) * h * textureKindSize(kind_));
+		std::memcpy(m_pixels.data(), pixels, m_pixels.size());
+	}
+}
+
+RendererNull::RendererNull(){}
+
+RendererNull::~RendererNull(){
+	log::infoLn(
+		"Null renderer presented {} frames, {} draws, {} instances, {} bytes",
+		m_counters.frames, m_counters.draws, m_counters.instances, m_counters.bytes
+	);
+}
+
+void RendererNull::init(){
+	log::infoLn("Using the null renderer, nothing will be drawn");
+}
+
+void RendererNull::present(const Camera *cam) noexcept{
+	m_commands.clear();
+
+	auto snap = snapshot();
+	std::uint32_t idx = 0;
+
+	for(auto &&group : managed<render::Group>()){
+		group->draw();
+
+		auto &&cmd = m_commands.emplace_back(static_cast<const RenderGroupNull*>(group.get())->drawCommand(idx++, snap));
+
+		++m_counters.draws;
+		m_counters.instances += cmd.numInstances;
+		m_counters.bytes += cmd.bytes;
+	}
+
+	++m_counters.frames;
+}
+
+void RendererNull::extract(render::FrameSnapshot &snap){
+	for(auto &&group : managed<render::Group>()){
+		static_cast<RenderGroupNull*>(group.get())->extract(snap.slot);
+	}
+}
+
+UniquePtr<render::Group> RendererNull::doCreateGroup(
+	std::uint32_t numShapes, const VertexShape **shapes,
+	Vector<render::InstanceData> instanceDataInfo
+){
+	return makeUnique<RenderGroupNull>(std::move(instanceDataInfo), numShapes, shapes);
+}
+
+UniquePtr<render::Texture> RendererNull::doCreateTexture(std::uint16_t w, std::uint16_t h, render::TextureKind kind, const void *pixels){
+	return makeUnique<RenderTextureNull>(w, h, kind, pixels);
+}
+
+UniquePtr<render::Program> RendererNull::doCreateProgram(render::ProgramKind kind, std::string_view src){
+	return makeUnique<RenderProgramNull>(kind, src);
+}
+
+UniquePtr<render::Pipeline> RendererNull::doCreatePipeline(const Vector<render::Program*> &progs){
+	return makeUnique<RenderPipelineNull>(progs);
+}
+
+UniquePtr<render::Framebuffer> RendererNull::doCreateFramebuffer(
+	std::uint16_t w, std::uint16_t h, const Vector<render::TextureKind> &attachments
+){
+	return makeUnique<RenderFramebufferNull>(w, h, attachments);
+}
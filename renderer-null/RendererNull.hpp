@@ -0,0 +1,164 @@
+#ifndef GPWE_RENDERER_NULL_HPP
+#define GPWE_RENDERER_NULL_HPP 1
+
+#include "gpwe/render.hpp"
+
+namespace gpwe{
+	/**
+	 * @brief What present would have drawn for one group.
+	 * Each buffer is counted once per draw, however many instances read it.
+	 */
+	struct NullDrawCommand{
+		std::uint32_t group; // position in the renderer's group list
+		std::uint32_t numShapes;
+		std::uint32_t numIndices; // per instance, over every shape
+		std::uint32_t numInstances;
+		std::uint64_t bytes; // vertex, index and instance data read
+	};
+
+	class RenderGroupNull: public render::Group{
+		public:
+			explicit RenderGroupNull(
+				Vector<render::InstanceData> instDataInfo,
+				std::uint32_t numShapes, const VertexShape **shapes
+			);
+
+			// nothing to issue, present reads drawCommand instead
+			void draw() const noexcept override{}
+
+			// copy the live instances into a snapshot slot, like the GL renderer does
+			void extract(std::uint32_t slot);
+
+			// for the instances a snapshot holds, or the live ones when null
+			NullDrawCommand drawCommand(std::uint32_t idx, const render::FrameSnapshot *snap = nullptr) const noexcept;
+
+		protected:
+			void *dataPtr(std::uint32_t idx) override;
+
+			UniquePtr<render::Instance> doCreateInstance() override;
+
+		private:
+			struct Slot{
+				Vector<char> data;
+				std::uint32_t numInstances = 0;
+			};
+
+			std::uint32_t m_numShapes;
+			Vector<Vec3> m_verts, m_norms;
+			Vector<Vec2> m_uvs;
+			Vector<std::uint32_t> m_indices;
+			Vector<char> m_data;
+			Slot m_slots[render::maxFrameSnapshots];
+			std::uint32_t m_numAllocated = 0;
+	};
+
+	class RenderInstanceNull: public render::Instance{
+		public:
+			RenderInstanceNull(RenderGroupNull *group_, std::uint32_t idx_) noexcept
+				: Instance(group_, idx_){}
+	};
+
+	class RenderTextureNull: public render::Texture{
+		public:
+			RenderTextureNull(std::uint16_t w, std::uint16_t h, Kind kind_, const void *pixels);
+
+			std::uint16_t width() const noexcept{ return m_w; }
+			std::uint16_t height() const noexcept{ return m_h; }
+			Kind kind() const noexcept{ return m_kind; }
+
+			// empty if created without pixels
+			const Vector<char> &pixels() const noexcept{ return m_pixels; }
+
+		private:
+			std::uint16_t m_w, m_h;
+			Kind m_kind;
+			Vector<char> m_pixels;
+	};
+
+	class RenderProgramNull: public render::Program{
+		public:
+			RenderProgramNull(Kind kind_, std::string_view src)
+				: m_kind(kind_), m_src(src){}
+
+			Kind kind() const noexcept override{ return m_kind; }
+
+			const Str &source() const noexcept{ return m_src; }
+
+		private:
+			Kind m_kind;
+			Str m_src;
+	};
+
+	class RenderPipelineNull: public render::Pipeline{
+		public:
+			explicit RenderPipelineNull(const Vector<render::Program*> &progs)
+				: m_progs(progs){}
+
+			void use() const noexcept override{}
+
+		private:
+			Vector<render::Program*> m_progs;
+	};
+
+	class RenderFramebufferNull: public render::Framebuffer{
+		public:
+			RenderFramebufferNull(std::uint16_t w, std::uint16_t h, const Vector<render::Texture::Kind> &attachments)
+				: m_w(w), m_h(h), m_attachments(attachments){}
+
+			void use(Mode mode) noexcept override{}
+
+			std::uint16_t width() const noexcept override{ return m_w; }
+			std::uint16_t height() const noexcept override{ return m_h; }
+
+			std::uint32_t numAttachments() const noexcept override{ return m_attachments.size(); }
+			render::TextureKind attachmentKind(std::uint32_t idx) const noexcept override{ return m_attachments[idx]; }
+
+		private:
+			std::uint16_t m_w, m_h;
+			Vector<render::TextureKind> m_attachments;
+	};
+
+	/**
+	 * @brief Renderer that keeps everything on the CPU and draws nothing.
+	 * present logs a NullDrawCommand per group in place of GL calls, for
+	 * measuring the render side of the engine and running without a GPU.
+	 */
+	class RendererNull: public render::Manager{
+		public:
+			RendererNull();
+			~RendererNull();
+
+			void init() override;
+
+			void present(const Camera *cam) noexcept override;
+
+			void extract(render::FrameSnapshot &snap) override;
+
+			render::Counters counters() const noexcept override{ return m_counters; }
+
+			// commands from the last present
+			const Vector<NullDrawCommand> &commands() const noexcept{ return m_commands; }
+
+		protected:
+			UniquePtr<render::Group> doCreateGroup(
+				std::uint32_t numShapes, const VertexShape **shapes,
+				Vector<render::InstanceData> instanceDataInfo
+			) override;
+
+			UniquePtr<render::Texture> doCreateTexture(std::uint16_t w, std::uint16_t h, render::TextureKind kind, const void *pixels) override;
+
+			UniquePtr<render::Program> doCreateProgram(render::ProgramKind kind, std::string_view src) override;
+
+			UniquePtr<render::Pipeline> doCreatePipeline(const Vector<render::Program*> &progs) override;
+
+			UniquePtr<render::Framebuffer> doCreateFramebuffer(
+				std::uint16_t w, std::uint16_t h, const Vector<render::TextureKind> &attachments
+			) override;
+
+		private:
+			Vector<NullDrawCommand> m_commands;
+			render::Counters m_counters;
+	};
+}
+
+#endif // !GPWE_RENDERER_NULL_HPP
@@ -37,85 +37,40 @@ void TestApp::init(){
 		log::warnLn("could not open '/Assets/Models/SphereGuy.fbx'");
 	}
 
-	inputs->onPumpEvents([this]{
-		rot = { 0.f, 0.f, 0.f };
-	});
-
 	inputs->system()->onExitEvent(sys::exit);
+}
 
-	auto &&kb = inputs->managed<input::Keyboard>().front();
-
-	kb->keyEvent().addFn([this](input::Key key, bool pressed){
-		using Key = input::Key;
-
-		switch(key){
-			case Key::w:{
-				movement.z += pressed ? 1.f : -1.f;
-				break;
-			}
-
-			case Key::s:{
-				movement.z -= pressed ? 1.f : -1.f;
-				break;
-			}
-
-			case Key::a:{
-				movement.x -= pressed ? 1.f : -1.f;
-				break;
-			}
-
-			case Key::d:{
-				movement.x += pressed ? 1.f : -1.f;
-				break;
-			}
-
-			case Key::space:{
-				movement.y += pressed ? 1.f : -1.f;
-				break;
-			}
-
-			case Key::lctrl:{
-				movement.y -= pressed ? 1.f : -1.f;
-				break;
-			}
-
-			case Key::escape:{
-				sys::inputManager()->system()->exitEvent();
-				break;
-			}
+void TestApp::update(float dt){
+	using Key = input::Key;
+	using Button = input::MouseButton;
 
-			default: break;
-		}
-	});
+	auto inputs = sys::inputManager();
+	auto &&in = inputs->snapshot();
 
-	auto &&mouse = inputs->managed<input::Mouse>().front();
+	if(in.keyPressed(Key::escape)){
+		inputs->system()->exitEvent();
+		return;
+	}
 
-	mouse->buttonEvent().addFn([&mouse, this](input::MouseButton btn, bool pressed){
-		using Button = input::MouseButton;
+	if(in.buttonPressed(Button::right) || in.buttonReleased(Button::right)){
+		rotateCam = in.buttonDown(Button::right);
 
-		if(btn == Button::right){
-			mouse->setCapture(pressed);
-			mouse->setRelativeMode(pressed);
-			rotateCam = pressed;
+		// hosts without a mouse device still replay button events
+		if(auto &&mice = inputs->managed<input::Mouse>(); !mice.empty()){
+			auto &&mouse = mice.front();
+			mouse->setCapture(rotateCam);
+			mouse->setRelativeMode(rotateCam);
 		}
-	});
-
-	mouse->moveEvent().addFn([this](std::int32_t xrel, std::int32_t yrel){
-		if(!rotateCam) return;
+	}
 
-		rot.x += xrel;
-		rot.y += yrel;
-	});
+	if(!rotateCam) return;
 
-	mouse->scrollEvent().addFn([this](Int32 xrel, Int32 yrel){
-		if(!rotateCam) return;
+	moveSpeed += in.scrollY * 0.25f;
 
-		moveSpeed += yrel * 0.25f;
-	});
-}
+	auto axis = [&in](Key pos, Key neg){ return float(in.keyDown(pos)) - float(in.keyDown(neg)); };
 
-void TestApp::update(float dt){
-	if(!rotateCam) return;
+	const glm::vec3 movement(axis(Key::d, Key::a), axis(Key::space, Key::lctrl), axis(Key::w, Key::s));
+	glm::vec3 rot(float(in.mouseDx), float(in.mouseDy), 0.f);
 
 	auto cam = sys::camera();
 
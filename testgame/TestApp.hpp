@@ -18,7 +18,6 @@ class TestApp: public gpwe::app::Manager{
 		gpwe::render::Group *terrainGroup, *cubeGroup, *guyGroup;
 		gpwe::render::Instance *terrainInst;
 		bool rotateCam = false;
-		glm::vec3 rot = { 0.f, 0.f, 0.f }, movement = { 0.f, 0.f, 0.f };
 
 		float rotSpeed = 2.f;
 		float moveSpeed = 2.f;
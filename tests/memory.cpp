@@ -0,0 +1,69 @@
+#include <cstdio>
+
+#include "gpwe/memory.hpp"
+#include "gpwe/world.hpp"
+#include "gpwe/util/Pool.hpp"
+
+using namespace gpwe;
+
+namespace {
+	class TestEntity: public world::Entity{};
+
+	class TestBlock: public world::Block{
+		public:
+			using world::Block::makeManaged;
+
+		protected:
+			UniquePtr<world::Entity> doCreateEntity() override{
+				return makeManaged<TestEntity>();
+			}
+	};
+
+	static_assert(TestBlock::isPooled<TestEntity>());
+
+	bool check(bool cond, const char *what){
+		if(!cond){
+			std::fprintf(stderr, "FAILED: %s\n", what);
+		}
+
+		return cond;
+	}
+}
+
+int main(){
+	if constexpr(!sys::memoryTracking()){
+		std::printf("built without GPWE_MEMORY_TRACKING, skipping\n");
+		return 77;
+	}
+
+	constexpr std::size_t numEnts = 1000;
+
+	sys::MemoryTagScope tag(ManagerKind::world);
+
+	// the pool itself and the vector come from the heap, keep them out of the counts
+	const auto blockSize = pool<TestEntity>().objSize();
+
+	Vector<UniquePtr<world::Entity>> ents;
+	ents.reserve(numEnts);
+
+	const auto before = sys::memoryStats(ManagerKind::world);
+
+	for(std::size_t i = 0; i < numEnts; i++){
+		ents.emplace_back(TestBlock::makeManaged<TestEntity>());
+	}
+
+	const auto live = sys::memoryStats(ManagerKind::world);
+
+	bool ok = true;
+	ok &= check(live.liveCount - before.liveCount == numEnts, "pooled objects counted against their manager");
+	ok &= check(live.liveBytes - before.liveBytes == numEnts * blockSize, "pooled bytes counted against their manager");
+	ok &= check(live.totalCount - before.totalCount == numEnts, "pooled allocations added to the total");
+
+	ents.clear();
+
+	const auto after = sys::memoryStats(ManagerKind::world);
+	ok &= check(after.liveCount == before.liveCount, "pooled frees credited back");
+	ok &= check(after.liveBytes == before.liveBytes, "pooled bytes credited back");
+
+	return ok ? 0 : 1;
+}
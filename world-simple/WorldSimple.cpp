@@ -11,14 +11,14 @@ worldSimple::Manager::~Manager(){}
 void worldSimple::Manager::init(){}
 
 UniquePtr<world::Block> worldSimple::Manager::doCreateBlock(){
-	return makeUnique<worldSimple::Block>();
+	return makeManaged<worldSimple::Block>();
 }
 
 worldSimple::Block::Block(){}
 worldSimple::Block::~Block(){}
 
 UniquePtr<world::Entity> worldSimple::Block::doCreateEntity(){
-	return makeUnique<worldSimple::Entity>();
+	return makeManaged<worldSimple::Entity>();
 }
 
 worldSimple::Entity::Entity(){}